@@ -21,6 +21,10 @@
 /********************************* Includes *******************************/
 
 #include "clUtils.h"
+#include "fitnessCache.h"
+#include "partitionTable.h"
+#include "profiler.h"
+#include "rng.h"
 #include <mpi.h>
 
 /********************************* Methods ********************************/
@@ -40,8 +44,11 @@ Individual* createSubpopulations(const Config *const conf);
  * @param devicesObject Structure containing the OpenCL variables of a device
  * @param trDataBase The training database which will contain the instances and the features
  * @param selInstances The instances choosen as initial centroids
+ * @param fitnessCache The cache containing the raw fitness of the chromosomes already evaluated. NULL if it is disabled
+ * @param partitionTable The table containing the K-means partitions of the evaluated chromosomes. NULL if the warm start is disabled
+ * @param profiler The profiler which records the commands executed by the devices. NULL if the profiling is disabled
  * @param conf The structure with all configuration parameters
  */
-void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *const trDataBase, const int *const selInstances, const Config *const conf);
+void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *const trDataBase, const int *const selInstances, FitnessCache *const fitnessCache, PartitionTable *const partitionTable, Profiler *const profiler, const Config *const conf);
 
 #endif
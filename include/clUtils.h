@@ -21,11 +21,14 @@
 /********************************* Includes *******************************/
 
 #include "individual.h" // Individual
+#include "scratchArena.h" // ScratchArena
 #include <CL/cl.h> // OpenCL
 #include <vector> // std::vector...
 
 /******************************** Constants *******************************/
 
+const cl_device_type CL_EVALUATION_DEVICE_TYPES = CL_DEVICE_TYPE_GPU | CL_DEVICE_TYPE_CPU | CL_DEVICE_TYPE_ACCELERATOR; // OpenCL devices able to run the kernels
+
 const char *const CL_ERROR_PLATFORMS_NUMBER = "Error: Could not get the number of platforms";
 const char *const CL_ERROR_PLATFORMS_FOUND = "Error: Platforms not found";
 const char *const CL_ERROR_PLATFORM_ID = "Error: Could not get the platform id";
@@ -35,6 +38,7 @@ const char *const CL_ERROR_DEVICE_NAME = "Error: Could not get the device name";
 const char *const CL_ERROR_DEVICE_MAXCU = "Error: Could not get maximum number of compute units";
 const char *const CL_ERROR_DEVICE_MAXWORKITEMS = "Error: Could not get maximum number of work-items in each dimension";
 const char *const CL_ERROR_DEVICE_TYPE = "Error: Could not get the device type";
+const char *const CL_ERROR_DEVICE_VERSION = "Error: Could not get the version of the device or its driver";
 const char *const CL_ERROR_DEVICE_MAXMEM = "Error: Could not get the maximum local memory of the device";
 const char *const CL_ERROR_DEVICE_LOCALMEM = "Error: Local memory exceeded";
 const char *const CL_ERROR_DEVICE_CONTEXT = "Error: Could not get the context";
@@ -43,7 +47,9 @@ const char *const CL_ERROR_FILE_OPEN = "Error: An error ocurred opening the kern
 const char *const CL_ERROR_PROGRAM_BUILD = "Error: Could not create the program";
 const char *const CL_ERROR_PROGRAM_ERRORS = "Error: Could not get the compilation errors";
 const char *const CL_ERROR_KERNEL_BUILD = "Error: Could not create the kernel";
-const char *const CL_ERROR_OBJECT_SUBPOPS = "Error: Could not create the OpenCL object containing the subpopulations";
+const char *const CL_ERROR_OBJECT_CHROMOSOMES = "Error: Could not create the OpenCL object containing the packed chromosomes";
+const char *const CL_ERROR_OBJECT_SCRATCH = "Error: Could not create the OpenCL objects containing the state of the instances of each work-group";
+const char *const CL_ERROR_OBJECT_RESULTS = "Error: Could not create the OpenCL object containing the fitness of the individuals";
 const char *const CL_ERROR_OBJECT_TRDB = "Error: Could not create the OpenCL object containing the training database";
 const char *const CL_ERROR_OBJECT_CENTROIDS = "Error: Could not create the OpenCL object containing the indexes of the initial centroids";
 const char *const CL_ERROR_KERNEL_ARGUMENT1 = "Error: Could not set the first kernel argument";
@@ -54,7 +60,16 @@ const char *const CL_ERROR_ENQUEUE_CENTROIDS = "Error: Could not enqueue the Ope
 const char *const CL_ERROR_OBJECT_TTRDB = "Error: Could not create the OpenCL object containing the transposed training database";
 const char *const CL_ERROR_ENQUEUE_TTRDB = "Error: Could not enqueue the OpenCL object containing the transposed training database";
 const char *const CL_ERROR_KERNEL_ARGUMENT6 = "Error: Could not set the sixth kernel argument";
+const char *const CL_ERROR_KERNEL_ARGUMENT7 = "Error: Could not set the seventh kernel argument";
+const char *const CL_ERROR_KERNEL_ARGUMENT8 = "Error: Could not set the eighth kernel argument";
+const char *const CL_ERROR_KERNEL_ARGUMENT9 = "Error: Could not set the ninth kernel argument";
+const char *const CL_ERROR_KERNEL_ARGUMENT10 = "Error: Could not set the tenth kernel argument";
 const char *const CL_ERROR_DEVICE_FOUND = "Error: Not exists the specified device";
+const char *const CL_ERROR_KERNEL_WORKGROUP = "Error: Could not get the work-group information of the kernel";
+const char *const CL_ERROR_TUNING_OPEN = "Error: An error ocurred opening or writting the tuning file";
+const char *const CL_ERROR_TUNING_RUN = "Error: Could not run or time the kernel while tuning the device";
+
+const int TILE_INSTANCES = 1024; // Instances of each tile of the mapping table cached in local memory by the tiled kernel
 
 /********************************* Structures ********************************/
 
@@ -76,6 +91,12 @@ typedef struct CLDevice {
 	cl_device_type deviceType;
 
 
+	/**
+	 * @brief true if the device is the CPU evaluated with OpenMP instead of an OpenCL device
+	 */
+	bool openMP;
+
+
 	/**
 	 * @brief The context associated to the device
 	 */
@@ -88,6 +109,12 @@ typedef struct CLDevice {
 	cl_command_queue commandQueue;
 
 
+	/**
+	 * @brief The OpenCL program built for the device. It is kept to create other kernel variants
+	 */
+	cl_program program;
+
+
 	/**
 	 * @brief The OpenCL kernel with the implementation of K-means
 	 */
@@ -107,9 +134,15 @@ typedef struct CLDevice {
 
 
 	/**
-	 * @brief OpenCL object which contains the current subpopulations
+	 * @brief OpenCL object which contains the bit-packed chromosomes of the current subpopulations
+	 */
+	cl_mem objChromosomes;
+
+
+	/**
+	 * @brief OpenCL object which contains the fitness and the number of K-means iterations of the evaluated individuals
 	 */
-	cl_mem objSubpopulations;
+	cl_mem objResults;
 
 
 	/**
@@ -118,6 +151,30 @@ typedef struct CLDevice {
 	cl_mem objTransposedTrDataBase;
 
 
+	/**
+	 * @brief OpenCL object which contains the distance of each instance to its nearest centroid in each work-group. Only used by the 'KERNEL_TILED' variant
+	 */
+	cl_mem objDistances;
+
+
+	/**
+	 * @brief OpenCL object which contains the nearest centroid of each instance in each work-group. Only used by the 'KERNEL_TILED' variant
+	 */
+	cl_mem objMappings;
+
+
+	/**
+	 * @brief The variant of the OpenCL kernel used by this device ('KERNEL_BASIC', 'KERNEL_REDUCTION', 'KERNEL_PACKED' or 'KERNEL_TILED')
+	 */
+	int kernelVariant;
+
+
+	/**
+	 * @brief The number of individuals evaluated at the same time by each work-group (1 except for the 'KERNEL_PACKED' variant)
+	 */
+	int packing;
+
+
 	/**
 	 * @brief The number of compute units specified for this device
 	 */
@@ -142,8 +199,42 @@ typedef struct CLDevice {
 	std::string deviceName;
 
 
+	/**
+	 * @brief The number of individuals per second evaluated by this device. It is measured during the evaluation and kept between generations (0 if it has not been measured yet)
+	 */
+	double throughput;
+
+
+	/**
+	 * @brief The number of individuals evaluated by this device
+	 */
+	long long nEvaluated;
+
+
+	/**
+	 * @brief The number of K-means iterations executed by this device
+	 */
+	long long nIterKmeans;
+
+
+	/**
+	 * @brief The scratch arenas of the OpenMP threads (one for each compute unit). NULL on OpenCL devices
+	 */
+	ScratchArena *scratch;
+
+
 	/********************************* Methods ********************************/
 
+	/**
+	 * @brief The constructor. The device is not associated to any OpenCL device nor has scratch arenas
+	 */
+	CLDevice() {
+		this -> device = NULL;
+		this -> openMP = false;
+		this -> scratch = NULL;
+	}
+
+
 	/**
 	 * @brief The destructor
 	 */
@@ -164,6 +255,14 @@ typedef struct CLDevice {
 CLDevice *createDevices(const float *const trDataBase, const int *const selInstances, const float *const transposedTrDataBase, Config *const conf);
 
 
+/**
+ * @brief Measures the best kernel variant, compute units and local work-items of each OpenCL device and stores them in the tuning file of the host
+ * @param devices The OpenCL devices, already created with the database of the experiment
+ * @param conf The structure with all configuration parameters
+ */
+void autotuneDevices(CLDevice *const devices, const Config *const conf);
+
+
 /**
  * @brief Gets the IDs of all available OpenCL devices
  * @return A vector containing the IDs of all devices
@@ -40,8 +40,27 @@ const char *const CFG_ERROR_CU_LOWER = "Error: Specified lower number of compute
 const char *const CFG_ERROR_WI_LOWER = "Error: Specified lower number of local work-items than number of devices";
 const char *const CFG_ERROR_THREADS_MIN = "Error: The number of CPU threads must be 0 or higher if the number of devices is 0, or 1 otherwise";
 const char *const CFG_ERROR_FEATURES_MIN = "Error: The number of features must be 4 or higher";
+const char *const CFG_ERROR_FCACHE_MIN = "Error: The size of the fitness cache must be 0 or higher";
+const char *const CFG_ERROR_WARMSTART_MIN = "Error: The size of the warm start table must be 0 or higher";
+const char *const CFG_ERROR_WARMSTART_OPENCL = "Error: The warm start is only available in the CPU evaluation. It must be 0 if OpenCL devices are used";
+const char *const CFG_ERROR_MAXITER_MIN = "Error: The maximum number of iterations of K-means must be 1 or higher";
+const char *const CFG_ERROR_KTOL_RANGE = "Error: The tolerance of K-means must be between 0 and 1";
+const char *const CFG_ERROR_CENTROIDS_RANGE = "Error: The number of centroids of K-means must be between 2 and 255, and not higher than the number of instances";
+const char *const CFG_ERROR_KALG_UNKNOWN = "Error: Unknown K-means algorithm. The available ones are Lloyd, Hamerly and Gemm";
+const char *const CFG_ERROR_KVAR_UNKNOWN = "Error: Unknown OpenCL kernel variant. The available ones are Basic, Reduction, Packed and Tiled";
+const char *const CFG_ERROR_KVAR_LOWER = "Error: Specified lower number of kernel variants than number of devices";
 const char *const CFG_ERROR_SIZE_MIN = "Error: The minimum number of MPI processes must be 1 or higher";
 
+const int KMEANS_LLOYD = 0; // Brute-force K-means (all distances are computed in each iteration)
+const int KMEANS_HAMERLY = 1; // K-means accelerated with the triangle inequality (Hamerly's algorithm)
+const int KMEANS_GEMM = 2; // K-means of blocks of individuals whose distances are computed with a matrix product
+
+const int KERNEL_UNSET = -1; // No OpenCL kernel variant specified. The tuned one of the device is used if it exists and 'KERNEL_BASIC' otherwise
+const int KERNEL_BASIC = 0; // OpenCL kernel whose centroid update and fitness are computed coordinate by coordinate by the work-items
+const int KERNEL_REDUCTION = 1; // OpenCL kernel whose centroid update and fitness are computed with reductions of the whole work-group
+const int KERNEL_PACKED = 2; // OpenCL kernel which evaluates several individuals in each work-group (one slice of work-items for each one)
+const int KERNEL_TILED = 3; // OpenCL kernel which keeps the state of the instances in global memory. Its local memory does not depend on the number of instances
+
 /******************************** Structures ******************************/
 
 /**
@@ -154,13 +173,59 @@ typedef struct Config {
 	std::string kernelsFileName;
 
 
+	/**
+	 * @brief The parameter indicating the directory where the built OpenCL programs are stored to be reused (empty to disable the cache)
+	 */
+	std::string programCacheDir;
+
+
+	/**
+	 * @brief The parameter indicating the name of the file with the tuned settings of the devices of the host
+	 */
+	std::string tuningFileName;
+
+
+	/**
+	 * @brief The parameter indicating if the devices must be tuned instead of running the genetic algorithm
+	 */
+	bool autotune;
+
+
+	/**
+	 * @brief The parameter indicating the variant of the OpenCL kernel used by each device in the evaluation ('KERNEL_BASIC', 'KERNEL_REDUCTION', 'KERNEL_PACKED', 'KERNEL_TILED' or 'KERNEL_UNSET')
+	 */
+	int *kernelVariants;
+
+
 	/**
 	 * @brief The parameter indicating the number of OpenMP threads to perform the evaluation of the individuals
 	 */
 	int ompThreads;
 
 
-	/********************************* Internal parameters ********************************/
+	/**
+	 * @brief The parameter indicating the maximum number of chromosomes whose fitness is stored in the fitness cache (0 to disable the cache)
+	 */
+	int fitnessCacheSize;
+
+
+	/**
+	 * @brief The parameter indicating the maximum number of K-means partitions stored to warm-start the children (0 disables the warm start).
+	 * The partitions are shared by the islands and the threads of a process, so the warm start makes the results depend on the number of processes and threads
+	 */
+	int warmStartSize;
+
+
+	/**
+	 * @brief The parameter indicating the name of the file where the profiling of the devices is written (empty to disable the profiling)
+	 */
+	std::string profileFileName;
+
+
+	/**
+	 * @brief The parameter indicating the seed of the random number generators. The same seed reproduces the same run
+	 */
+	unsigned long long seed;
 
 
 	/**
@@ -169,12 +234,27 @@ typedef struct Config {
 	int K;
 
 
+	/**
+	 * @brief The parameter indicating the algorithm used by K-means in the CPU evaluation ('KMEANS_LLOYD', 'KMEANS_HAMERLY' or 'KMEANS_GEMM')
+	 */
+	int kmeansAlgorithm;
+
+
 	/**
 	 * @brief The parameter indicating the number of maximum iterations for the convergence of K-means
 	 */
 	int maxIterKmeans;
 
 
+	/**
+	 * @brief The parameter indicating the maximum fraction of instances which can change their cluster in an iteration to consider that K-means has converged
+	 */
+	float kmeansTolerance;
+
+
+	/********************************* Internal parameters ********************************/
+
+
 	/**
 	 * @brief The parameter indicating the size of the pool (the half of the subpopulation size)
 	 */
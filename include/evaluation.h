@@ -21,14 +21,18 @@
 /********************************* Includes *******************************/
 
 #include "clUtils.h"
+#include "fitnessCache.h"
+#include "partitionTable.h"
+#include "profiler.h"
 
 /******************************** Constants *******************************/
 
-const char *const EV_ERROR_ENQUEUE_INDIVIDUALS = "Error: Could not enqueue the OpenCL object containing the individuals";
+const char *const EV_ERROR_ENQUEUE_INDIVIDUALS = "Error: Could not enqueue the OpenCL object containing the packed chromosomes";
 const char *const EV_ERROR_KERNEL_ARGUMENT4 = "Error: Could not set the fourth kernel argument";
 const char *const EV_ERROR_KERNEL_ARGUMENT5 = "Error: Could not set the fifth kernel argument";
 const char *const EV_ERROR_ENQUEUE_KERNEL = "Error: Could not run the kernel";
 const char *const EV_ERROR_ENQUEUE_READING = "Error: Could not read the data from the device";
+const char *const EV_ERROR_PROFILING = "Error: Could not get the profiling information of the kernel";
 const char *const EV_ERROR_DATA_OPEN = "Error: An error ocurred opening or writting the data file";
 const char *const EV_ERROR_PLOT_OPEN = "Error: An error ocurred opening or writting the plot file";
 const char *const EV_ERROR_OBJECTIVES_NUMBER = "Error: Gnuplot is only available for two objectives by now. Not generated gnuplot file";
@@ -36,6 +40,22 @@ const char *const EV_ERROR_OBJECTIVES_NUMBER = "Error: Gnuplot is only available
 /********************************* Methods ********************************/
 
 
+/**
+ * @brief Gets the size of a bit-packed chromosome, as it is sent to the OpenCL devices
+ * @param conf The structure with all configuration parameters
+ * @return The number of bytes of the chromosome
+ */
+int packedChromosomeSize(const Config *const conf);
+
+
+/**
+ * @brief Gets the size of the scratch arena needed by each thread of the CPU evaluation
+ * @param conf The structure with all configuration parameters
+ * @return The size in bytes of the arena
+ */
+size_t evaluationScratchSize(const Config *const conf);
+
+
 /**
  * @brief Evaluation of each individual in CPU in Sequential mode or using OpenMP
  * @param subpop The first individual to evaluate of the current subpopulation
@@ -43,9 +63,11 @@ const char *const EV_ERROR_OBJECTIVES_NUMBER = "Error: Gnuplot is only available
  * @param trDataBase The training database which will contain the instances and the features
  * @param selInstances The instances choosen as initial centroids
  * @param nThreads The number of threads to perform the individuals evaluation
+ * @param arenas The scratch arenas of the threads. There must be one for each thread
+ * @param partitionTable The table containing the K-means partitions of the evaluated chromosomes. NULL if the warm start is disabled
  * @param conf The structure with all configuration parameters
  */
-void evaluationCPU(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, const Config *const conf);
+void evaluationCPU(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, ScratchArena *const arenas, PartitionTable *const partitionTable, const Config *const conf);
 
 
 /**
@@ -56,9 +78,22 @@ void evaluationCPU(Individual *const subpop, const int nIndividuals, const float
  * @param nDevices The number of devices that will execute the evaluation
  * @param trDataBase The training database which will contain the instances and the features
  * @param selInstances The instances choosen as initial centroids
+ * @param fitnessCache The cache containing the raw fitness of the chromosomes already evaluated. NULL if it is disabled
+ * @param partitionTable The table containing the K-means partitions of the evaluated chromosomes. NULL if the warm start is disabled
+ * @param profiler The profiler which records the commands executed by the devices. NULL if the profiling is disabled
+ * @param island The island (subpopulation) whose individuals are evaluated
+ * @param generation The generation of the island
+ * @param conf The structure with all configuration parameters
+ */
+void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, FitnessCache *const fitnessCache, PartitionTable *const partitionTable, Profiler *const profiler, const int island, const int generation, const Config *const conf);
+
+
+/**
+ * @brief Prints the number of individuals evaluated by each device and the average number of K-means iterations per individual
+ * @param devicesObject Structure containing the OpenCL variables of a device
  * @param conf The structure with all configuration parameters
  */
-void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, const Config *const conf);
+void printEvaluationStats(const CLDevice *const devicesObject, const Config *const conf);
 
 
 /**
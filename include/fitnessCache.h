@@ -0,0 +1,186 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file fitnessCache.h
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Function declarations of the cache which stores the fitness of the already evaluated chromosomes
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+#ifndef FITNESSCACHE_H
+#define FITNESSCACHE_H
+
+/********************************* Includes *******************************/
+
+#include <omp.h> // omp_lock_t
+#include <stdint.h> // uint64_t
+
+/******************************** Constants *******************************/
+
+const int FC_WAYS = 8; // Number of entries of each set of the cache
+const int FC_LOCKS = 64; // Number of locks shared by the sets of the cache
+
+/********************************* Structures ********************************/
+
+/**
+ * @brief Structure containing the 128-bit hash of a chromosome
+ */
+typedef struct FitnessKey {
+
+
+	/**
+	 * @brief The first 64 bits of the hash. They also select the set of the cache
+	 */
+	uint64_t h1;
+
+
+	/**
+	 * @brief The last 64 bits of the hash
+	 */
+	uint64_t h2;
+
+} FitnessKey;
+
+
+/**
+ * @brief Structure containing an entry of the cache
+ */
+typedef struct FitnessEntry {
+
+
+	/**
+	 * @brief The hash of the chromosome
+	 */
+	FitnessKey key;
+
+
+	/**
+	 * @brief The raw fitness (before normalization) of the chromosome
+	 */
+	float fitness[2];
+
+
+	/**
+	 * @brief If the entry contains a chromosome or not
+	 */
+	bool used;
+
+
+	/**
+	 * @brief If the entry has been accessed since the last time the clock hand visited it
+	 */
+	bool referenced;
+
+} FitnessEntry;
+
+
+/**
+ * @brief Structure containing a bounded and concurrent cache of fitness values
+ *
+ * The cache is set-associative. Each set contains 'FC_WAYS' entries and the CLOCK algorithm chooses the entry to be replaced inside the set.
+ * Sharing it between islands does not change the results, because the fitness only depends on the chromosome unless the warm start is enabled
+ */
+typedef struct FitnessCache {
+
+
+	/**
+	 * @brief The entries of the cache
+	 */
+	FitnessEntry *entries;
+
+
+	/**
+	 * @brief The position of the clock hand in each set
+	 */
+	unsigned char *hands;
+
+
+	/**
+	 * @brief The number of sets of the cache
+	 */
+	int nSets;
+
+
+	/**
+	 * @brief The locks protecting the sets. The set 's' is protected by the lock 's % FC_LOCKS'
+	 */
+	omp_lock_t locks[FC_LOCKS];
+
+
+	/**
+	 * @brief The number of lookups which found the chromosome
+	 */
+	long long hits;
+
+
+	/**
+	 * @brief The number of lookups which did not find the chromosome
+	 */
+	long long misses;
+
+
+	/**
+	 * @brief The number of entries replaced by the CLOCK algorithm
+	 */
+	long long evictions;
+
+
+	/********************************* Methods ********************************/
+
+	/**
+	 * @brief The constructor with parameters
+	 * @param capacity The maximum number of chromosomes stored in the cache. It is rounded up to a multiple of 'FC_WAYS'
+	 */
+	FitnessCache(const int capacity);
+
+
+	/**
+	 * @brief The destructor
+	 */
+	~FitnessCache();
+
+
+	/**
+	 * @brief Looks for a chromosome in the cache
+	 * @param key The hash of the chromosome
+	 * @param fitness The raw fitness of the chromosome will be stored if it is found
+	 * @return true if the chromosome was found
+	 */
+	bool lookup(const FitnessKey &key, float *const fitness);
+
+
+	/**
+	 * @brief Inserts the raw fitness of a chromosome in the cache. If its set is full, an entry is replaced
+	 * @param key The hash of the chromosome
+	 * @param fitness The raw fitness (before normalization) of the chromosome
+	 */
+	void insert(const FitnessKey &key, const float *const fitness);
+
+
+	/**
+	 * @brief Prints the hit-rate counters of the cache
+	 * @param mpiRank The MPI process number which is calling the function
+	 */
+	void printStats(const int mpiRank);
+
+} FitnessCache;
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Gets the 128-bit hash of a chromosome
+ * @param chromosome The bit-packed chromosome to be hashed
+ * @param nFeatures The number of features of the chromosome
+ * @return The hash of the chromosome
+ */
+FitnessKey hashChromosome(const uint64_t *const chromosome, const int nFeatures);
+
+#endif
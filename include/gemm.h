@@ -0,0 +1,47 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file gemm.h
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Function declarations of the cache-blocked matrix product used by the batched K-means
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+#ifndef GEMM_H
+#define GEMM_H
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Gets the size of the workspace needed by the matrix product
+ * @return The number of floats of the workspace
+ */
+int sgemmWorkspaceSize();
+
+
+/**
+ * @brief Computes the product C = A * B^T in simple precision. All the matrices are stored in row-major order
+ *
+ * The matrices are split in blocks which fit in the caches and packed for a vectorized micro-kernel. Each element of C adds the products in the same order with all the instruction sets, so the results do not depend on the CPU
+ * @param M The number of rows of A and C
+ * @param N The number of rows of B and columns of C
+ * @param depth The number of columns of A and B
+ * @param A The first matrix
+ * @param lda The distance between two consecutive rows of A
+ * @param B The second matrix
+ * @param ldb The distance between two consecutive rows of B
+ * @param C The resulting matrix will be stored
+ * @param ldc The distance between two consecutive rows of C
+ * @param workspace Buffer of 'sgemmWorkspaceSize()' floats aligned to 64 bytes where the blocks are packed
+ */
+void sgemmNT(const int M, const int N, const int depth, const float *const A, const int lda, const float *const B, const int ldb, float *const C, const int ldc, float *const workspace);
+
+#endif
@@ -21,6 +21,11 @@
 /********************************** Includes *********************************/
 
 #include "config.h" // 'Config' datatype
+#include <stdint.h> // uint64_t
+
+/******************************** Constants *******************************/
+
+const int CHROMOSOME_WORDS = (N_FEATURES + 63) / 64; // Words of 64 bits of a bit-packed chromosome
 
 /********************************* Structures ********************************/
 
@@ -31,11 +36,11 @@ typedef struct Individual {
 
 
 	/**
-	 * @brief Vector denoting the selected features
+	 * @brief Bit-packed vector denoting the selected features (64 genes per word, the first gene in the lowest bit)
 	 *
-	 * Values: Zeros or ones
+	 * Values: Zeros or ones. The bits after the last feature are always zero
 	 */
-	unsigned char chromosome[N_FEATURES];
+	uint64_t chromosome[CHROMOSOME_WORDS];
 
 
 	/**
@@ -65,6 +70,73 @@ typedef struct Individual {
 	 */
 	int nSelFeatures;
 
+
+	/**
+	 * @brief Number of K-means iterations executed in the last evaluation of the individual
+	 */
+	int nIterKmeans;
+
+
+	/**
+	 * @brief Hash of the chromosome of the primary parent. K-means starts from the partition of the parent if the warm start is enabled
+	 *
+	 * Values: 0 if the individual has not a parent
+	 */
+	uint64_t parentKey;
+
+
+	/********************************* Methods ********************************/
+
+	/**
+	 * @brief Gets a gene of the chromosome
+	 * @param f The feature of the gene
+	 * @return 1 if the feature is selected, 0 otherwise
+	 */
+	int getGene(const int f) const {
+		return (int) ((this -> chromosome[f >> 6] >> (f & 63)) & 1);
+	}
+
+
+	/**
+	 * @brief Selects a feature of the chromosome
+	 * @param f The feature of the gene
+	 */
+	void setGene(const int f) {
+		this -> chromosome[f >> 6] |= 1ULL << (f & 63);
+	}
+
+
+	/**
+	 * @brief Unselects a feature of the chromosome
+	 * @param f The feature of the gene
+	 */
+	void clearGene(const int f) {
+		this -> chromosome[f >> 6] &= ~(1ULL << (f & 63));
+	}
+
+
+	/**
+	 * @brief Unselects all the features of the chromosome
+	 */
+	void clearChromosome() {
+		for (int w = 0; w < CHROMOSOME_WORDS; ++w) {
+			this -> chromosome[w] = 0;
+		}
+	}
+
+
+	/**
+	 * @brief Counts the selected features of the chromosome
+	 * @return The number of genes set to '1'
+	 */
+	int countGenes() const {
+		int count = 0;
+		for (int w = 0; w < CHROMOSOME_WORDS; ++w) {
+			count += __builtin_popcountll(this -> chromosome[w]);
+		}
+		return count;
+	}
+
 } Individual;
 
 
@@ -76,11 +148,12 @@ struct rankCompare {
 
 	/**
 	 * @brief Compare individuals according to their ranks
-	 * @param ind1 The first individual
-	 * @param ind2 The second individual
+	 * @param ind1 The first individual (or its sorting key)
+	 * @param ind2 The second individual (or its sorting key)
 	 * @return true if the rank of the first individual is lower than the rank of the second individual
 	 */
-	bool operator ()(const Individual &ind1, const Individual &ind2) const {
+	template <typename T>
+	bool operator ()(const T &ind1, const T &ind2) const {
 		return ind1.rank < ind2.rank;
 	}
 };
@@ -111,11 +184,12 @@ struct objectiveCompare {
 
 	/**
 	 * @brief Compare individuals according to their objectives
-	 * @param ind1 The first individual
-	 * @param ind2 The second individual
+	 * @param ind1 The first individual (or its sorting key)
+	 * @param ind2 The second individual (or its sorting key)
 	 * @return true if the fitness of the first individual is lower than the fitness of the second individual
 	 */
-	bool operator ()(const Individual &ind1, const Individual &ind2) const {
+	template <typename T>
+	bool operator ()(const T &ind1, const T &ind2) const {
 		return ind1.fitness[this -> objective] < ind2.fitness[this -> objective];
 	}
 };
@@ -131,11 +205,12 @@ struct rankAndCrowdingCompare {
 
 	/**
 	 * @brief Compare individuals according to their ranks and their crowding distances
-	 * @param ind1 The first individual
-	 * @param ind2 The second individual
+	 * @param ind1 The first individual (or its sorting key)
+	 * @param ind2 The second individual (or its sorting key)
 	 * @return true if the rank of the first individual is lower than the rank of the second individual. If both individuals have the same rank, the crowding distance will be compared
 	 */
-	bool operator ()(const Individual &ind1, const Individual &ind2) const {
+	template <typename T>
+	bool operator ()(const T &ind1, const T &ind2) const {
 		if (ind1.rank == ind2.rank) {
 			return ind1.crowding > ind2.crowding;
 		}
@@ -0,0 +1,124 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file partitionTable.h
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Function declarations of the table which stores the final K-means partitions used to warm-start the children
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+#ifndef PARTITIONTABLE_H
+#define PARTITIONTABLE_H
+
+/********************************* Includes *******************************/
+
+#include <omp.h> // omp_lock_t
+#include <stdint.h> // uint64_t
+
+/******************************** Constants *******************************/
+
+const int PT_LOCKS = 64; // Number of locks shared by the entries of the table
+
+/********************************* Structures ********************************/
+
+/**
+ * @brief Structure containing a bounded and concurrent table with the final partition (cluster of each instance) of the evaluated chromosomes
+ *
+ * The table is direct-mapped: a chromosome replaces the one stored in its entry.
+ * It is shared by all the islands and threads of a process, so the partition found for a parent depends on the order of the evaluations
+ */
+typedef struct PartitionTable {
+
+
+	/**
+	 * @brief The partitions. Each entry contains 'nInstances' elements
+	 */
+	unsigned char *partitions;
+
+
+	/**
+	 * @brief The hash of the chromosome stored in each entry. 0 if the entry is empty
+	 */
+	uint64_t *keys;
+
+
+	/**
+	 * @brief The number of entries of the table
+	 */
+	int capacity;
+
+
+	/**
+	 * @brief The number of instances of each partition
+	 */
+	int nInstances;
+
+
+	/**
+	 * @brief The locks protecting the entries. The entry 'e' is protected by the lock 'e % PT_LOCKS'
+	 */
+	omp_lock_t locks[PT_LOCKS];
+
+
+	/**
+	 * @brief The number of lookups which found the partition of the parent
+	 */
+	long long hits;
+
+
+	/**
+	 * @brief The number of lookups which did not find the partition of the parent
+	 */
+	long long misses;
+
+
+	/********************************* Methods ********************************/
+
+	/**
+	 * @brief The constructor with parameters
+	 * @param capacity The maximum number of partitions stored in the table
+	 * @param nInstances The number of instances of each partition
+	 */
+	PartitionTable(const int capacity, const int nInstances);
+
+
+	/**
+	 * @brief The destructor
+	 */
+	~PartitionTable();
+
+
+	/**
+	 * @brief Looks for the partition of a chromosome
+	 * @param key The hash of the chromosome. 0 always fails
+	 * @param partition The partition will be stored if it is found
+	 * @return true if the partition was found
+	 */
+	bool lookup(const uint64_t key, unsigned char *const partition);
+
+
+	/**
+	 * @brief Stores the partition of a chromosome, replacing the previous content of its entry
+	 * @param key The hash of the chromosome
+	 * @param partition The cluster of each instance
+	 */
+	void insert(const uint64_t key, const unsigned char *const partition);
+
+
+	/**
+	 * @brief Prints the hit-rate counters of the table
+	 * @param mpiRank The MPI process number which is calling the function
+	 */
+	void printStats(const int mpiRank);
+
+} PartitionTable;
+
+#endif
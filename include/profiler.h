@@ -0,0 +1,190 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file profiler.h
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Function declarations of the profiler which records the commands executed by the devices during the evaluation
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+/********************************* Includes *******************************/
+
+#include "clUtils.h" // CLDevice
+#include <omp.h> // omp_lock_t
+#include <string> // std::string
+#include <vector> // std::vector
+
+/******************************** Constants *******************************/
+
+const char *const PROF_ERROR_EVENT = "Error: Could not get the profiling information of an OpenCL command";
+const char *const PROF_ERROR_FILE_OPEN = "Error: An error ocurred opening or writting the profiling file";
+
+const int PROF_WRITE = 0; // Copy of the chromosomes onto the device
+const int PROF_KERNEL = 1; // Execution of K-means (kernel or OpenMP evaluation)
+const int PROF_READ = 2; // Copy of the fitness from the device
+
+/********************************* Structures ********************************/
+
+/**
+ * @brief Structure containing the timestamps of a command executed by a device. The timestamps are in nanoseconds of the clock of the device
+ */
+typedef struct ProfileRecord {
+
+
+	/**
+	 * @brief The index of the device which executed the command
+	 */
+	int device;
+
+
+	/**
+	 * @brief The island (subpopulation) whose individuals were evaluated
+	 */
+	int island;
+
+
+	/**
+	 * @brief The generation of the island
+	 */
+	int generation;
+
+
+	/**
+	 * @brief The kind of command ('PROF_WRITE', 'PROF_KERNEL' or 'PROF_READ')
+	 */
+	int phase;
+
+
+	/**
+	 * @brief The number of individuals of the chunk
+	 */
+	int nIndividuals;
+
+
+	/**
+	 * @brief The moment when the command was enqueued
+	 */
+	unsigned long long queued;
+
+
+	/**
+	 * @brief The moment when the command was submitted to the device
+	 */
+	unsigned long long submit;
+
+
+	/**
+	 * @brief The moment when the command started its execution
+	 */
+	unsigned long long start;
+
+
+	/**
+	 * @brief The moment when the command finished its execution
+	 */
+	unsigned long long end;
+
+} ProfileRecord;
+
+
+/**
+ * @brief Structure containing the commands executed by the devices. The transfer, compute and idle times are aggregated per device, island and generation
+ */
+typedef struct Profiler {
+
+
+	/**
+	 * @brief The first device. The index of a device is its position from this one
+	 */
+	const CLDevice *devices;
+
+
+	/**
+	 * @brief The number of devices
+	 */
+	int nDevices;
+
+
+	/**
+	 * @brief The recorded commands
+	 */
+	std::vector<ProfileRecord> records;
+
+
+	/**
+	 * @brief The lock protecting the recorded commands
+	 */
+	omp_lock_t lock;
+
+
+	/********************************* Methods ********************************/
+
+	/**
+	 * @brief The constructor with parameters
+	 * @param devices The devices whose commands will be recorded
+	 * @param nDevices The number of devices
+	 */
+	Profiler(const CLDevice *const devices, const int nDevices);
+
+
+	/**
+	 * @brief The destructor
+	 */
+	~Profiler();
+
+
+	/**
+	 * @brief Records a command executed by a device
+	 * @param device The device which executed the command
+	 * @param island The island whose individuals were evaluated
+	 * @param generation The generation of the island
+	 * @param phase The kind of command ('PROF_WRITE', 'PROF_KERNEL' or 'PROF_READ')
+	 * @param nIndividuals The number of individuals of the chunk
+	 * @param queued The moment when the command was enqueued
+	 * @param submit The moment when the command was submitted to the device
+	 * @param start The moment when the command started its execution
+	 * @param end The moment when the command finished its execution
+	 */
+	void record(const CLDevice *const device, const int island, const int generation, const int phase, const int nIndividuals, const unsigned long long queued, const unsigned long long submit, const unsigned long long start, const unsigned long long end);
+
+
+	/**
+	 * @brief Records an OpenCL command already finished
+	 * @param device The device which executed the command
+	 * @param island The island whose individuals were evaluated
+	 * @param generation The generation of the island
+	 * @param phase The kind of command ('PROF_WRITE', 'PROF_KERNEL' or 'PROF_READ')
+	 * @param nIndividuals The number of individuals of the chunk
+	 * @param event The event associated to the command
+	 */
+	void record(const CLDevice *const device, const int island, const int generation, const int phase, const int nIndividuals, const cl_event event);
+
+
+	/**
+	 * @brief Prints a table with the transfer, compute and idle time of each device
+	 * @param mpiRank The MPI process number which is calling the function
+	 */
+	void printStats(const int mpiRank);
+
+
+	/**
+	 * @brief Writes the transfer, compute and idle time of each device, island and generation in CSV format
+	 * @param fileName The name of the file
+	 * @param mpiRank The MPI process number which is calling the function
+	 */
+	void write(const std::string &fileName, const int mpiRank);
+
+} Profiler;
+
+#endif
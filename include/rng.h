@@ -0,0 +1,156 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file rng.h
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Function declarations of the counter-based random number generator used by the genetic algorithm
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+#ifndef RNG_H
+#define RNG_H
+
+/********************************* Includes *******************************/
+
+#include <stdint.h> // uint32_t, uint64_t
+#include <math.h> // log
+
+/******************************** Constants *******************************/
+
+const int RNG_INIT = 0; // Stream used to initialize the individuals of a subpopulation
+const int RNG_CENTROIDS = 1; // Stream used to choose the initial centroids
+const int RNG_EVOLUTION = 2; // Stream used by the selection, crossover and mutation of a generation
+const int RNG_MIGRATION = 3; // Stream used by a migration between subpopulations
+
+/********************************* Structures ********************************/
+
+/**
+ * @brief Structure containing a stream of the Philox4x32-10 counter-based generator
+ *
+ * Each number depends only on the seed, the stream and its position in the stream, so the streams are independent and do not share any state. The numbers are generated in blocks of four
+ */
+typedef struct Rng {
+
+
+	/**
+	 * @brief The key of the generator (the seed)
+	 */
+	uint32_t key[2];
+
+
+	/**
+	 * @brief The counter of the next block. The first two words are the position of the block and the last two the stream
+	 */
+	uint32_t counter[4];
+
+
+	/**
+	 * @brief The current block of numbers
+	 */
+	uint32_t block[4];
+
+
+	/**
+	 * @brief The number of numbers of the current block already used
+	 */
+	int used;
+
+
+	/********************************* Methods ********************************/
+
+	/**
+	 * @brief The constructor with parameters
+	 * @param seed The seed of the run
+	 * @param stream The stream, obtained with 'rngStream'
+	 */
+	Rng(const uint64_t seed, const uint64_t stream);
+
+
+	/**
+	 * @brief Generates the next block of numbers and advances the counter
+	 */
+	void refill();
+
+
+	/**
+	 * @brief Gets the next random number
+	 * @return An uniformly distributed 32-bit number
+	 */
+	uint32_t next() {
+		if (this -> used == 4) {
+			refill();
+		}
+		return this -> block[(this -> used)++];
+	}
+
+
+	/**
+	 * @brief Gets the next random word of 64 bits
+	 * @return An uniformly distributed 64-bit number
+	 */
+	uint64_t next64() {
+		uint64_t high = next();
+		return (high << 32) | next();
+	}
+
+
+	/**
+	 * @brief Gets a random integer in the range [0, n)
+	 * @param n The upper bound of the range
+	 * @return The random integer
+	 */
+	int uniformInt(const int n) {
+		return (int) (((uint64_t) next() * (uint32_t) n) >> 32);
+	}
+
+
+	/**
+	 * @brief Gets a random float in the range [0, 1)
+	 * @return The random float
+	 */
+	float uniformFloat() {
+		return (next() >> 8) * (1.0f / 16777216.0f);
+	}
+
+
+	/**
+	 * @brief Gets a random double in the range [0, 1) with 53 random bits
+	 * @return The random double
+	 */
+	double uniformDouble() {
+		return (next64() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+
+	/**
+	 * @brief Gets the number of failures before the first success of a sequence of Bernoulli trials (geometric distribution)
+	 * @param logComplement The logarithm of the probability of failure of each trial, log(1 - p)
+	 * @return The number of failures. It is limited to 2^30, so it can be added to a position without overflow
+	 */
+	int geometric(const double logComplement) {
+		double gap = log(1.0 - uniformDouble()) / logComplement;
+		return (gap < 1073741824.0) ? (int) gap : 1073741824;
+	}
+
+} Rng;
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Gets the stream of a task of the genetic algorithm. The same task always gets the same stream, whatever thread or MPI process runs it
+ * @param kind The kind of task ('RNG_INIT', 'RNG_CENTROIDS', 'RNG_EVOLUTION' or 'RNG_MIGRATION')
+ * @param island The island (subpopulation) of the task
+ * @param generation The generation or migration of the task
+ * @return The stream
+ */
+uint64_t rngStream(const int kind, const int island, const int generation);
+
+#endif
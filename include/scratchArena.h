@@ -0,0 +1,116 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file scratchArena.h
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Function declarations of the per-thread memory arenas used as scratch space by the evaluation
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+#ifndef SCRATCHARENA_H
+#define SCRATCHARENA_H
+
+/********************************* Includes *******************************/
+
+#include "config.h" // check
+#include <stddef.h> // size_t
+
+/******************************** Constants *******************************/
+
+const char *const SA_ERROR_ALLOC = "Error: Could not allocate the scratch arena of the evaluation";
+const char *const SA_ERROR_CAPACITY = "Error: The scratch arena of the evaluation is too small";
+const size_t SA_ALIGNMENT = 64; // Each buffer starts in a different cache line
+
+/********************************* Structures ********************************/
+
+/**
+ * @brief Structure containing a memory arena owned by one thread
+ *
+ * The memory is reserved once and the buffers are carved from it with a bump pointer, so nothing is allocated during the evaluation. The buffers are aligned to 'SA_ALIGNMENT' bytes
+ */
+typedef struct ScratchArena {
+
+
+	/**
+	 * @brief The reserved memory
+	 */
+	char *memory;
+
+
+	/**
+	 * @brief The size in bytes of the reserved memory
+	 */
+	size_t capacity;
+
+
+	/**
+	 * @brief The number of bytes already given to the buffers
+	 */
+	size_t used;
+
+
+	/********************************* Methods ********************************/
+
+	/**
+	 * @brief The constructor. No memory is reserved
+	 */
+	ScratchArena();
+
+
+	/**
+	 * @brief The destructor
+	 */
+	~ScratchArena();
+
+
+	/**
+	 * @brief Reserves the memory of the arena. The previous memory is released
+	 * @param capacity The size in bytes of the arena
+	 */
+	void reserve(const size_t capacity);
+
+
+	/**
+	 * @brief Releases all the buffers of the arena (the memory remains reserved)
+	 */
+	void reset() {
+		this -> used = 0;
+	}
+
+
+	/**
+	 * @brief Gets an aligned buffer from the arena
+	 * @param n The number of elements of the buffer
+	 * @return A pointer to the buffer
+	 */
+	template <typename T>
+	T *alloc(const size_t n) {
+		size_t size = bytes<T>(n);
+		check(this -> used + size > this -> capacity, "%s\n", SA_ERROR_CAPACITY);
+		T *buffer = (T *) (this -> memory + this -> used);
+		this -> used += size;
+		return buffer;
+	}
+
+
+	/**
+	 * @brief Gets the number of bytes taken by a buffer of the arena
+	 * @param n The number of elements of the buffer
+	 * @return The size of the buffer rounded up to 'SA_ALIGNMENT'
+	 */
+	template <typename T>
+	static size_t bytes(const size_t n) {
+		return (((n * sizeof(T)) + SA_ALIGNMENT - 1) / SA_ALIGNMENT) * SA_ALIGNMENT;
+	}
+
+} ScratchArena;
+
+#endif
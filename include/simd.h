@@ -0,0 +1,56 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file simd.h
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Function declarations of the vectorized K-means kernels for the CPU
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+#ifndef SIMD_H
+#define SIMD_H
+
+/******************************** Constants *******************************/
+
+/**
+ * @brief Maximum number of instances computed at the same time by a kernel (one AVX-512 register)
+ *
+ * The rows of the feature-major matrices must be padded to a multiple of this value
+ */
+const int SIMD_MAX_WIDTH = 16;
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Assigns each instance to its nearest centroid (Euclidean distance)
+ *
+ * The K distances of several instances are kept in vector registers at the same time. Each lane adds the features in the same order, so all the instruction sets produce the same results
+ * @param selDataBase The selected features of the database in feature-major order. The rows are aligned and padded to 'SIMD_MAX_WIDTH'
+ * @param stride The length of each row of 'selDataBase'
+ * @param nSelFeatures The number of selected features (rows of 'selDataBase')
+ * @param centroids The centroids. Each one contains 'nSelFeatures' coordinates
+ * @param K The number of centroids
+ * @param begin The first instance to be assigned. It must be a multiple of 'SIMD_MAX_WIDTH'
+ * @param end The 'end-1' position is the last instance to be assigned
+ * @param mapping The nearest centroid of each instance will be stored
+ * @param distCentroids The squared distance to the nearest centroid of each instance will be stored
+ * @param secondDist The squared distance to the second nearest centroid of each instance will be stored. NULL if it is not needed
+ */
+void assignInstances(const float *const selDataBase, const int stride, const int nSelFeatures, const float *const centroids, const int K, const int begin, const int end, unsigned char *const mapping, float *const distCentroids, float *const secondDist);
+
+
+/**
+ * @brief Gets the name of the instruction set used by the K-means kernels
+ * @return The name of the instruction set selected at runtime
+ */
+const char *simdInstructionSet();
+
+#endif
@@ -23,13 +23,16 @@
 #include <numeric> // std::iota
 #include <omp.h> // OpenMP
 #include <set> // std::set
-#include <string.h> // memcpy, memset
+#include <math.h> // log
+#include <string.h> // memcpy
 
 /********************************* Defines ********************************/
 
 #define INITIALIZE 0
 #define IGNORE_VALUE 1
 #define FINISH 2
+#define MUTATION_PROBABILITY 0.1 // Probability of mutating each gene
+#define MUTATION_ONE_PROBABILITY 0.01f // Probability of setting a mutated gene to '1' (it is set to '0' otherwise)
 
 /********************************* Methods ********************************/
 
@@ -40,12 +43,13 @@ void printSubpopulations(const Individual *const subpops, const int nSubpopulati
 		for (int i = 0; i < conf -> subpopulationSize; ++i) {
 			fprintf(stdout, "Process %d: Individual %d: ", conf -> mpiRank, i);
 			for (int f = 0; f < conf -> nFeatures; ++f)  {
-				fprintf(stdout, " %d", subpops[i].chromosome[f]);
+				fprintf(stdout, " %d", subpops[i].getGene(f));
 			}
 			fprintf(stdout, " * Rank: %d", subpops[i].rank);
 			fprintf(stdout, " * Fit0: %f", subpops[sp * conf -> familySize + i].fitness[0]);
 			fprintf(stdout, " * Fit1: %f", subpops[sp * conf -> familySize + i].fitness[1]);
 			fprintf(stdout, "* Crow: %f", subpops[i].crowding);
+			fprintf(stdout, " * Iter: %d", subpops[i].nIterKmeans);
 			fprintf(stdout, "\n");
 		}
 	}
@@ -66,24 +70,28 @@ Individual* createSubpopulations(const Config *const conf) {
 	// Allocate memory for parents and children
 	Individual *subpops = new Individual[conf -> totalIndividuals];
 	for (int i = 0; i < conf -> totalIndividuals; ++i) {
-		memset(subpops[i].chromosome, 0, conf -> nFeatures * sizeof(unsigned char));
+		subpops[i].clearChromosome();
 		for (unsigned char obj = 0; obj < conf -> nObjectives; ++obj) {
 			subpops[i].fitness[obj] = 0.0f;
 		}
 		subpops[i].crowding = 0.0f;
 		subpops[i].rank = -1;
 		subpops[i].nSelFeatures = 0;
+		subpops[i].nIterKmeans = 0;
+		subpops[i].parentKey = 0;
 	}
 
 	// Only the parents of each subpopulation are initialized
 	for (int it = 0; it < conf -> totalIndividuals; it += conf -> familySize) {
+		Rng rng(conf -> seed, rngStream(RNG_INIT, it / conf -> familySize, 0));
 		for (int i = it; i < it + conf -> subpopulationSize; ++i) {
 
 			// Set value '1' 'conf -> maxFeatures' decision variables at most
 			for (int mf = 0; mf < conf -> maxFeatures; ++mf) {
-				int randomFeature = rand() % conf -> nFeatures;
-				if (!(subpops[i].chromosome[randomFeature] & 1)) {
-					subpops[i].nSelFeatures += (subpops[i].chromosome[randomFeature] = 1);
+				int randomFeature = rng.uniformInt(conf -> nFeatures);
+				if (!subpops[i].getGene(randomFeature)) {
+					subpops[i].setGene(randomFeature);
+					++(subpops[i].nSelFeatures);
 				}
 			}
 		}
@@ -95,10 +103,11 @@ Individual* createSubpopulations(const Config *const conf) {
 
 /**
  * @brief Tournament between randomly selected individuals. The best individuals are stored in the pool
+ * @param rng The random number generator of the generation
  * @param conf The structure with all configuration parameters
  * @return The pool with the selected individuals
  */
-int* getPool(const Config *const conf) {
+int* getPool(Rng *const rng, const Config *const conf) {
 
 	// Create and fill the pool
 	int *pool = new int[conf -> poolSize];
@@ -107,7 +116,7 @@ int* getPool(const Config *const conf) {
 
 		// std::set guarantees unique elements in the insert function
 		for (int j = 0; j < conf -> tourSize; ++j) {
-			candidates.insert(rand() % conf -> subpopulationSize);
+			candidates.insert(rng -> uniformInt(conf -> subpopulationSize));
 		}
 
 		// At this point, the individuals already are sorted by rank and crowding distance
@@ -120,22 +129,53 @@ int* getPool(const Config *const conf) {
 }
 
 
+/**
+ * @brief Perform random mutation on a copy of an individual. Each gene is mutated with probability 'MUTATION_PROBABILITY'
+ *
+ * The gaps between consecutive mutated genes follow a geometric distribution, so they are sampled directly and the cost depends on the number of mutations instead of the number of features
+ * @param parent The individual to be mutated
+ * @param child The mutated individual will be stored
+ * @param rng The random number generator of the generation
+ * @param conf The structure with all configuration parameters
+ */
+static void mutationGeometric(const Individual *const parent, Individual *const child, Rng *const rng, const Config *const conf) {
+
+	static const double logComplement = log(1.0 - MUTATION_PROBABILITY);
+	for (int w = 0; w < CHROMOSOME_WORDS; ++w) {
+		child -> chromosome[w] = parent -> chromosome[w];
+	}
+
+	// The mutated genes are set to '1' with 'MUTATION_ONE_PROBABILITY' and to '0' otherwise
+	for (int f = rng -> geometric(logComplement); f < conf -> nFeatures; f += 1 + rng -> geometric(logComplement)) {
+		if (rng -> uniformFloat() <= MUTATION_ONE_PROBABILITY) {
+			child -> setGene(f);
+		}
+		else {
+			child -> clearGene(f);
+		}
+	}
+}
+
+
 /**
  * @brief Perform binary crossover between two individuals (uniform crossover)
  * @param subpop Current subpopulation
  * @param pool Position of the selected individuals for the crossover
+ * @param rng The random number generator of the generation
  * @param conf The structure with all configuration parameters
  * @return The number of generated children
  */
-int crossoverUniform(Individual *const subpop, const int *const pool, const Config *const conf) {
+int crossoverUniform(Individual *const subpop, const int *const pool, Rng *const rng, const Config *const conf) {
 
 	// Reset the children
 	for (int i = conf -> subpopulationSize; i < conf -> familySize; ++i) {
-		memset(subpop[i].chromosome, 0, conf -> nFeatures * sizeof(unsigned char));
+		subpop[i].clearChromosome();
 		for (unsigned char obj = 0; obj < conf -> nObjectives; ++obj) {
 			subpop[i].fitness[obj] = 0.0f;
 		}
 		subpop[i].nSelFeatures = 0;
+		subpop[i].nIterKmeans = 0;
+		subpop[i].parentKey = 0;
 		subpop[i].rank = -1;
 		subpop[i].crowding = 0.0f;
 	}
@@ -144,37 +184,44 @@ int crossoverUniform(Individual *const subpop, const int *const pool, const Conf
 	for (int i = 0; i < conf -> poolSize; ++i) {
 
 		// 75% probability perform crossover. Two childen are generated
-		Individual *parent1 = &(subpop[pool[rand() % conf -> poolSize]]);
-		if ((rand() / (float) RAND_MAX) < 0.75f) {
+		Individual *parent1 = &(subpop[pool[rng -> uniformInt(conf -> poolSize)]]);
+		if (rng -> uniformFloat() < 0.75f) {
 
 			// Avoid repeated parents
-			Individual *parent2 = &(subpop[pool[rand() % conf -> poolSize]]);
+			Individual *parent2 = &(subpop[pool[rng -> uniformInt(conf -> poolSize)]]);
 			Individual *child2 = child + 1;
 			while (parent1 == parent2) {
-				parent2 = &(subpop[pool[rand() % conf -> poolSize]]);
+				parent2 = &(subpop[pool[rng -> uniformInt(conf -> poolSize)]]);
 			}
 
-			// Perform uniform crossover for each decision variable in the chromosome
-			for (int f = 0; f < conf -> nFeatures; ++f) {
+			// Each child warm-starts from the parent which gives it most of its genes
+			if (conf -> warmStartSize > 0) {
+				child -> parentKey = hashChromosome(parent1 -> chromosome, conf -> nFeatures).h1;
+				child2 -> parentKey = hashChromosome(parent2 -> chromosome, conf -> nFeatures).h1;
+			}
 
-				// 50% probability perform copy the decision variable of the other parent
-				if ((parent1 -> chromosome[f] != parent2 -> chromosome[f]) && ((rand() / (float) RAND_MAX) < 0.5f)) {
-					child -> nSelFeatures += (child -> chromosome[f] = parent2 -> chromosome[f]);
-					child2 -> nSelFeatures += (child2 -> chromosome[f] = parent1 -> chromosome[f]);
-				}
-				else {
-					child -> nSelFeatures += (child -> chromosome[f] = parent1 -> chromosome[f]);
-					child2 -> nSelFeatures += (child2 -> chromosome[f] = parent2 -> chromosome[f]);
+			// Perform uniform crossover on each word of the chromosome
+			// 50% probability perform copy the decision variable of the other parent. Only the different genes are swapped
+			for (int w = 0; w < CHROMOSOME_WORDS; ++w) {
+				uint64_t swap = parent1 -> chromosome[w] ^ parent2 -> chromosome[w];
+				if (swap != 0) {
+					swap &= rng -> next64();
 				}
+				child -> chromosome[w] = parent1 -> chromosome[w] ^ swap;
+				child2 -> chromosome[w] = parent2 -> chromosome[w] ^ swap;
 			}
+			child -> nSelFeatures = child -> countGenes();
+			child2 -> nSelFeatures = child2 -> countGenes();
 
 			// At least one decision variable must be set to '1'
 			if (child -> nSelFeatures == 0) {
-				child -> chromosome[rand() % conf -> nFeatures] = child -> nSelFeatures = 1;
+				child -> setGene(rng -> uniformInt(conf -> nFeatures));
+				child -> nSelFeatures = 1;
 			}
 
 			if (child2 -> nSelFeatures == 0) {
-				child2 -> chromosome[rand() % conf -> nFeatures] = child2 -> nSelFeatures = 1;
+				child2 -> setGene(rng -> uniformInt(conf -> nFeatures));
+				child2 -> nSelFeatures = 1;
 			}
 			child += 2;
 		}
@@ -183,27 +230,18 @@ int crossoverUniform(Individual *const subpop, const int *const pool, const Conf
 		// Mutation is based on random mutation
 		else {
 
-			// Perform mutation on each element of the selected parent
-			for (int f = 0; f < conf -> nFeatures; ++f) {
-
-				// 10% probability perform mutation (gen level)
-				float probability = (rand() / (float) RAND_MAX);
-				if (probability < 0.1f) {
-					if ((rand() / (float) RAND_MAX) > 0.01f) {
-						child -> chromosome[f] = 0;
-					}
-					else {
-						child -> nSelFeatures += (child -> chromosome[f] = 1);
-					}
-				}
-				else {
-					child -> nSelFeatures += (child -> chromosome[f] = parent1 -> chromosome[f]);
-				}
+			if (conf -> warmStartSize > 0) {
+				child -> parentKey = hashChromosome(parent1 -> chromosome, conf -> nFeatures).h1;
 			}
 
+			// Perform mutation on the selected parent
+			mutationGeometric(parent1, child, rng, conf);
+			child -> nSelFeatures = child -> countGenes();
+
 			// At least one decision variable must be set to '1'
 			if (child -> nSelFeatures == 0) {
-				child -> chromosome[rand() % conf -> nFeatures] = child -> nSelFeatures = 1;
+				child -> setGene(rng -> uniformInt(conf -> nFeatures));
+				child -> nSelFeatures = 1;
 			}
 			++child;
 		}
@@ -218,9 +256,10 @@ int crossoverUniform(Individual *const subpop, const int *const pool, const Conf
  * @param subpops The subpopulations
  * @param nSubpopulations The number of subpopulations involved in the migration
  * @param nIndsFronts0 The number of individuals in the front 0 of each subpopulation
+ * @param rng The random number generator of the migration
  * @param conf The structure with all configuration parameters
  */
-void migration(Individual *const subpops, const int nSubpopulations, const int *const nIndsFronts0, const Config *const conf) {
+void migration(Individual *const subpops, const int nSubpopulations, const int *const nIndsFronts0, Rng *const rng, const Config *const conf) {
 
 	// From subpopulations randomly choosen some individuals of the front 0 are copied to each subpopulation (the worst individuals are deleted)
 	for (int subpop = 0; subpop < nSubpopulations; ++subpop) {
@@ -231,7 +270,9 @@ void migration(Individual *const subpops, const int nSubpopulations, const int *
 
 		// The current subpopulation will not copy its own individuals
 		randomIndex.erase(randomIndex.begin() + subpop);
-		std::random_shuffle(randomIndex.begin(), randomIndex.end());
+		for (int i = (int) randomIndex.size() - 1; i > 0; --i) {
+			std::swap(randomIndex[i], randomIndex[rng -> uniformInt(i + 1)]);
+		}
 
 		int maxCopy = conf -> subpopulationSize - nIndsFronts0[subpop];
 		Individual *ptrDest = subpops + (subpop * conf -> familySize) + conf -> subpopulationSize;
@@ -264,17 +305,22 @@ void migration(Individual *const subpops, const int nSubpopulations, const int *
  * @param devicesObject Structure containing the information of a device
  * @param trDataBase The training database which will contain the instances and the features
  * @param selInstances The instances choosen as initial centroids
+ * @param fitnessCache The cache containing the raw fitness of the chromosomes already evaluated. NULL if it is disabled
+ * @param partitionTable The table containing the K-means partitions of the evaluated chromosomes. NULL if the warm start is disabled
+ * @param profiler The profiler which records the commands executed by the devices. NULL if the profiling is disabled
+ * @param island The island (subpopulation) which is evolved
+ * @param firstGeneration The number of generations already evolved by the island. The initial evaluation is reported as this generation
  * @param conf The structure with all configuration parameters
  * @param initialize If the subpopulation must be initialized or not
  */
-void evolve(Individual *const subpop, int *const nIndsFronts0, CLDevice *const devicesObject, const float *const trDataBase, const int *const selInstances, const Config *const conf, const bool initialize) {
+void evolve(Individual *const subpop, int *const nIndsFronts0, CLDevice *const devicesObject, const float *const trDataBase, const int *const selInstances, FitnessCache *const fitnessCache, PartitionTable *const partitionTable, Profiler *const profiler, const int island, const int firstGeneration, const Config *const conf, const bool initialize) {
 
 
 	/********** Multi-objective individuals evaluation over all subpopulations ***********/
 
 	int nDevices = (omp_get_num_threads() > 1) ? 1 : conf -> nDevices;
 	if (initialize) {
-		evaluation(subpop, conf -> subpopulationSize, devicesObject, nDevices, trDataBase, selInstances, conf);
+		evaluation(subpop, conf -> subpopulationSize, devicesObject, nDevices, trDataBase, selInstances, fitnessCache, partitionTable, profiler, island, firstGeneration, conf);
 
 
 		/********** Sort the subpopulation with the 'Non-dominated sorting' method ***********/
@@ -290,8 +336,10 @@ void evolve(Individual *const subpop, int *const nIndsFronts0, CLDevice *const d
 
 		/********** Fill the mating pool and perform crossover ***********/
 
-		const int *const pool = getPool(conf);
-		int nChildren = crossoverUniform(subpop, pool, conf);
+		// Each generation of each island has its own random stream, so the result does not depend on the thread which evolves it
+		Rng rng(conf -> seed, rngStream(RNG_EVOLUTION, island, firstGeneration + g + 1));
+		const int *const pool = getPool(&rng, conf);
+		int nChildren = crossoverUniform(subpop, pool, &rng, conf);
 
 		// Local resources used are released
 		delete[] pool;
@@ -299,7 +347,7 @@ void evolve(Individual *const subpop, int *const nIndsFronts0, CLDevice *const d
 
 		/********** Multi-objective individuals evaluation over the subpopulation ***********/
 
-		evaluation(subpop + conf -> subpopulationSize, nChildren, devicesObject, nDevices, trDataBase, selInstances, conf);
+		evaluation(subpop + conf -> subpopulationSize, nChildren, devicesObject, nDevices, trDataBase, selInstances, fitnessCache, partitionTable, profiler, island, firstGeneration + g + 1, conf);
 
 
 		/********** The crowding distance of the parents is initialized again for the next nonDominationSort ***********/
@@ -322,21 +370,27 @@ void evolve(Individual *const subpop, int *const nIndsFronts0, CLDevice *const d
  * @param devicesObject Structure containing the OpenCL variables of a device
  * @param trDataBase The training database which will contain the instances and the features
  * @param selInstances The instances choosen as initial centroids
+ * @param fitnessCache The cache containing the raw fitness of the chromosomes already evaluated. NULL if it is disabled
+ * @param partitionTable The table containing the K-means partitions of the evaluated chromosomes. NULL if the warm start is disabled
+ * @param profiler The profiler which records the commands executed by the devices. NULL if the profiling is disabled
  * @param conf The structure with all configuration parameters
  */
-void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *const trDataBase, const int *const selInstances, const Config *const conf) {
+void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *const trDataBase, const int *const selInstances, FitnessCache *const fitnessCache, PartitionTable *const partitionTable, Profiler *const profiler, const Config *const conf) {
 
 
 	/********** MPI variables ***********/
 
 	MPI::Status status;
-	int array_of_blocklengths[3] = {conf -> nFeatures, conf -> nObjectives + 1, 2};
-	MPI::Datatype array_of_types[3] = {MPI::UNSIGNED_CHAR, MPI::FLOAT, MPI::INT};
+	int array_of_blocklengths[3] = {CHROMOSOME_WORDS, conf -> nObjectives + 1, 3};
+	MPI::Datatype array_of_types[3] = {MPI::UNSIGNED_LONG_LONG, MPI::FLOAT, MPI::INT};
 
 	// The 'Individual' datatype must be converted to a MPI datatype and commit it
 	MPI::Aint array_of_displacement[3] = {offsetof(Individual, chromosome), offsetof(Individual, fitness), offsetof(Individual, rank)};
-	MPI::Datatype Individual_MPI_type = MPI::Datatype::Create_struct(3, array_of_blocklengths, array_of_displacement, array_of_types);
+	// The extent is resized because the fields which are not sent (padding included) must be skipped between consecutive individuals
+	MPI::Datatype Individual_struct_type = MPI::Datatype::Create_struct(3, array_of_blocklengths, array_of_displacement, array_of_types);
+	MPI::Datatype Individual_MPI_type = Individual_struct_type.Create_resized(0, sizeof(Individual));
 	Individual_MPI_type.Commit();
+	Individual_struct_type.Free();
 
 
 	/******* Measure and start the master-worker algorithm *******/
@@ -359,12 +413,13 @@ void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *
 				#pragma omp parallel for num_threads(nThreads) schedule(dynamic, 1)
 				for (int sp = 0; sp < conf -> nSubpopulations; ++sp) {
 					int popIndex = sp * conf -> familySize;
-					evolve(subpops + popIndex, &nIndsFronts0[sp], &devicesObject[omp_get_thread_num()], trDataBase, selInstances, conf, gMig == 0);
+					evolve(subpops + popIndex, &nIndsFronts0[sp], &devicesObject[omp_get_thread_num()], trDataBase, selInstances, fitnessCache, partitionTable, profiler, sp, gMig * conf -> nGenerations, conf, gMig == 0);
 				}
 
 				// Migration process between subpopulations
 				if (gMig != conf -> nGlobalMigrations - 1 && conf -> nSubpopulations > 1) {
-					migration(subpops, conf -> nSubpopulations, nIndsFronts0, conf);
+					Rng rng(conf -> seed, rngStream(RNG_MIGRATION, 0, gMig));
+					migration(subpops, conf -> nSubpopulations, nIndsFronts0, &rng, conf);
 				}
 			}
 		}
@@ -383,49 +438,51 @@ void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *
 
 			/********** In each migration the individuals are exchanged between subpopulations of different nodes  ***********/
 
+			// Each subpopulation travels with a header, sent with the same tag to the same worker thread, containing its island and the generations already evolved.
+			// Thus the island is evolved with its own random streams and returned to its own place, whatever process and thread evolve it
 			for (int gMig = 0; gMig < conf -> nGlobalMigrations; ++gMig) {
 
-				// Send some work to the workers
+				// Send some work to the workers. Each thread of a worker receives the work through the tag of its number
 				int nextWork = 0;
-				int sent = 0;
-				int mpiTag = (gMig == 0) ? INITIALIZE : IGNORE_VALUE;
+				int header[3];
+				header[0] = (gMig == 0) ? INITIALIZE : IGNORE_VALUE;
+				header[2] = gMig * conf -> nGenerations;
 				for (int p = 1; p < conf -> mpiSize && nextWork < conf -> nSubpopulations; ++p) {
-						int finallyWork = std::min(workerCapacities[p - 1], conf -> nSubpopulations - nextWork);
-						int popIndex = nextWork * conf -> familySize;
-						requests[p - 1] = MPI::COMM_WORLD.Isend(subpops + popIndex, finallyWork * conf -> familySize, Individual_MPI_type, p, mpiTag);
-						nextWork += finallyWork;
-						++sent;
-				}
-				MPI::Request::Waitall(sent, requests);
-
-				// Dynamically distribute the subpopulations
-				int receivedPtr = 0;
-				while (nextWork < conf -> nSubpopulations) {
-					MPI::COMM_WORLD.Recv(subpops + (receivedPtr * conf -> familySize), conf -> familySize, Individual_MPI_type, MPI::ANY_SOURCE, MPI::ANY_TAG, status);
-					int popIndex = nextWork * conf -> familySize;
-					MPI::COMM_WORLD.Send(subpops + popIndex, conf -> familySize, Individual_MPI_type, status.Get_source(), mpiTag);
-					nIndsFronts0[receivedPtr] = status.Get_tag();
-					++receivedPtr;
-					++nextWork;
+					for (int slot = 0; slot < workerCapacities[p - 1] && nextWork < conf -> nSubpopulations; ++slot) {
+						header[1] = nextWork;
+						MPI::COMM_WORLD.Send(header, 3, MPI::INT, p, slot);
+						MPI::COMM_WORLD.Send(subpops + (nextWork * conf -> familySize), conf -> familySize, Individual_MPI_type, p, slot);
+						++nextWork;
+					}
 				}
 
-				// Receive the remaining work
-				while (receivedPtr < conf -> nSubpopulations) {
-					MPI::COMM_WORLD.Recv(subpops + (receivedPtr * conf -> familySize), conf -> familySize, Individual_MPI_type, MPI::ANY_SOURCE, MPI::ANY_TAG, status);
-					MPI::COMM_WORLD.Send(NULL, 0, MPI::INT, status.Get_source(), FINISH);
-					nIndsFronts0[receivedPtr] = status.Get_tag();
-					++receivedPtr;
+				// Dynamically distribute the subpopulations. Each one is received in the place of its island
+				for (int received = 0; received < conf -> nSubpopulations; ++received) {
+					int reply[2];
+					MPI::COMM_WORLD.Recv(reply, 2, MPI::INT, MPI::ANY_SOURCE, MPI::ANY_TAG, status);
+					MPI::COMM_WORLD.Recv(subpops + (reply[0] * conf -> familySize), conf -> familySize, Individual_MPI_type, status.Get_source(), status.Get_tag());
+					nIndsFronts0[reply[0]] = reply[1];
+					if (nextWork < conf -> nSubpopulations) {
+						header[1] = nextWork;
+						MPI::COMM_WORLD.Send(header, 3, MPI::INT, status.Get_source(), status.Get_tag());
+						MPI::COMM_WORLD.Send(subpops + (nextWork * conf -> familySize), conf -> familySize, Individual_MPI_type, status.Get_source(), status.Get_tag());
+						++nextWork;
+					}
 				}
 
 				// Migration process between subpopulations of different nodes
 				if (gMig != conf -> nGlobalMigrations - 1 && conf -> nSubpopulations > 1) {
-					migration(subpops, conf -> nSubpopulations, nIndsFronts0, conf);
+					Rng rng(conf -> seed, rngStream(RNG_MIGRATION, 0, gMig));
+					migration(subpops, conf -> nSubpopulations, nIndsFronts0, &rng, conf);
 				}
 			}
 
-			// Notify to all workers that the work has finished
+			// Notify to all threads of all workers that the work has finished
+			int header[3] = {FINISH, 0, 0};
 			for (int p = 1; p < conf -> mpiSize; ++p) {
-				requests[p - 1] = MPI::COMM_WORLD.Isend(NULL, 0, MPI::INT, p, FINISH);
+				for (int slot = 0; slot < workerCapacities[p - 1]; ++slot) {
+					MPI::COMM_WORLD.Send(header, 3, MPI::INT, p, slot);
+				}
 			}
 		}
 
@@ -449,7 +506,6 @@ void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *
 		}
 
 		// All processes must reach this point in order to provide a real time measure
-		MPI::Request::Waitall(conf -> mpiSize - 1, requests);
 		MPI::COMM_WORLD.Barrier();
 		fprintf(stdout, "%.10g\n", (omp_get_wtime() - timeStart) * 1000.0);
 
@@ -469,31 +525,24 @@ void agIslands(Individual *subpops, CLDevice *const devicesObject, const float *
 		omp_set_nested(1);
 		subpops = new Individual[conf -> nDevices * conf -> familySize];
 
-		// The worker receives as many subpopulations as number of devices at most
-		MPI::COMM_WORLD.Recv(subpops, conf -> nDevices * conf -> familySize, Individual_MPI_type, 0, MPI::ANY_TAG, status);
-
-		while (status.Get_tag() != FINISH) {
-			int nSubpopulations = status.Get_count(Individual_MPI_type) / conf -> familySize;
-			int EXIT = false;
-
-			#pragma omp parallel num_threads(nSubpopulations)
-			{
-				int threadID = omp_get_thread_num();
-				MPI::Request request;
-				MPI::Status stat = status;
-				int nIndsFronts0;
-				int popIndex = threadID * conf -> familySize;
-				do {
-					evolve(subpops + popIndex, &nIndsFronts0, &devicesObject[threadID], trDataBase, selInstances, conf, stat.Get_tag() == INITIALIZE);
-
-					// The Worker sends to the master the subpopulations already evaluated and will request new work
-					request = MPI::COMM_WORLD.Isend(subpops + popIndex, conf -> familySize, Individual_MPI_type, 0, nIndsFronts0);
-					request.Wait();
-					MPI::COMM_WORLD.Recv(subpops + popIndex, conf -> familySize, Individual_MPI_type, 0, MPI::ANY_TAG, stat);
-				} while (stat.Get_tag() != FINISH);
+		// Each thread receives the subpopulations through the tag of its number until the master notifies that the work has finished
+		#pragma omp parallel num_threads(conf -> nDevices)
+		{
+			int threadID = omp_get_thread_num();
+			int popIndex = threadID * conf -> familySize;
+			int header[3];
+			int reply[2];
+			MPI::COMM_WORLD.Recv(header, 3, MPI::INT, 0, threadID);
+			while (header[0] != FINISH) {
+				MPI::COMM_WORLD.Recv(subpops + popIndex, conf -> familySize, Individual_MPI_type, 0, threadID);
+				evolve(subpops + popIndex, &reply[1], &devicesObject[threadID], trDataBase, selInstances, fitnessCache, partitionTable, profiler, header[1], header[2], conf, header[0] == INITIALIZE);
+
+				// The worker sends to the master the island already evolved and will receive new work
+				reply[0] = header[1];
+				MPI::COMM_WORLD.Send(reply, 2, MPI::INT, 0, threadID);
+				MPI::COMM_WORLD.Send(subpops + popIndex, conf -> familySize, Individual_MPI_type, 0, threadID);
+				MPI::COMM_WORLD.Recv(header, 3, MPI::INT, 0, threadID);
 			}
-
-			MPI::COMM_WORLD.Recv(subpops, conf -> nDevices * conf -> familySize, Individual_MPI_type, 0, MPI::ANY_TAG, status);
 		}
 
 		// All process must reach this point in order to provide a real time measure
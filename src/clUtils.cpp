@@ -18,7 +18,20 @@
 /********************************* Includes *******************************/
 
 #include "clUtils.h"
+#include "evaluation.h"
+#include "simd.h"
 #include <string>
+#include <vector> // std::vector
+#include <fstream> // std::fstream
+#include <iterator> // std::istreambuf_iterator
+#include <algorithm> // std::min
+#include <stdint.h> // uint64_t
+#include <stdio.h> // FILE, rename...
+#include <sys/stat.h> // mkdir
+#include <sys/file.h> // flock
+#include <fcntl.h> // open
+#include <unistd.h> // getpid, close
+#include <string.h> // strcmp
 
 /********************************* Methods ********************************/
 
@@ -27,17 +40,479 @@
  */
 CLDevice::~CLDevice() {
 
-	if (this -> device != NULL && this -> deviceType != CL_DEVICE_TYPE_CPU) {
+	if (this -> device != NULL) {
 
 		// Resources used are released
 		clReleaseContext(this -> context);
 		clReleaseCommandQueue(this -> commandQueue);
 		clReleaseKernel(this -> kernel);
+		clReleaseProgram(this -> program);
 		clReleaseMemObject(this -> objTrDataBase);
 		clReleaseMemObject(this -> objTransposedTrDataBase);
 		clReleaseMemObject(this -> objSelInstances);
-		clReleaseMemObject(this -> objSubpopulations);
+		clReleaseMemObject(this -> objChromosomes);
+		clReleaseMemObject(this -> objResults);
+		if (this -> objDistances != NULL) {
+			clReleaseMemObject(this -> objDistances);
+			clReleaseMemObject(this -> objMappings);
+		}
+	}
+	delete[] this -> scratch;
+}
+
+
+/**
+ * @brief Adds a string to a 64-bit FNV-1a hash
+ * @param hash The current hash
+ * @param str The string to be added
+ * @return The new hash
+ */
+static uint64_t hashString(uint64_t hash, const std::string &str) {
+
+	for (size_t c = 0; c < str.size(); ++c) {
+		hash = (hash ^ (unsigned char) str[c]) * 0x100000001B3ULL;
+	}
+
+	// The length separates consecutive strings
+	return (hash ^ str.size()) * 0x100000001B3ULL;
+}
+
+
+/**
+ * @brief Gets the key of the program built for a device. Two devices with the same key can share the program binary
+ * @param device The OpenCL device
+ * @param source The source code of the program
+ * @param buildOptions The build options of the program
+ * @return The key as an hexadecimal string
+ */
+static std::string programKey(const cl_device_id device, const std::string &source, const char *const buildOptions) {
+
+	char name[256], driver[256], version[256], key[17];
+	check(clGetDeviceInfo(device, CL_DEVICE_NAME, sizeof(name), name, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_NAME);
+	check(clGetDeviceInfo(device, CL_DRIVER_VERSION, sizeof(driver), driver, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_VERSION);
+	check(clGetDeviceInfo(device, CL_DEVICE_VERSION, sizeof(version), version, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_VERSION);
+
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	hash = hashString(hash, name);
+	hash = hashString(hash, driver);
+	hash = hashString(hash, version);
+	hash = hashString(hash, source);
+	hash = hashString(hash, buildOptions);
+	sprintf(key, "%016llx", (unsigned long long) hash);
+	return key;
+}
+
+
+/**
+ * @brief Builds a program from its source code
+ * @param device The device whose context will contain the program
+ * @param source The source code of the program
+ * @param buildOptions The build options of the program
+ * @return The built program
+ */
+static cl_program programFromSource(const CLDevice *const device, const std::string &source, const char *const buildOptions) {
+
+	cl_int status;
+	const char *sourcePtr = source.c_str();
+	size_t sourceSize = source.size();
+	cl_program program = clCreateProgramWithSource(device -> context, 1, &sourcePtr, &sourceSize, &status);
+	check(status != CL_SUCCESS, "%s\n", CL_ERROR_PROGRAM_BUILD);
+
+	// Build program for the device in the context
+	if (clBuildProgram(program, 1, &(device -> device), buildOptions, 0, 0) != CL_SUCCESS) {
+		char buffer[4096];
+		fprintf(stderr, "Error: Could not build the program\n");
+		check(clGetProgramBuildInfo(program, device -> device, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_PROGRAM_ERRORS);
+		check(true, "%s\n", buffer);
+	}
+
+	return program;
+}
+
+
+/**
+ * @brief Builds a program from a binary previously built for the same kind of device
+ * @param device The device whose context will contain the program
+ * @param binary The binary of the program
+ * @param buildOptions The build options of the program
+ * @return The built program or NULL if the binary was rejected by the device (e.g. the driver has changed)
+ */
+static cl_program programFromBinary(const CLDevice *const device, const std::vector<unsigned char> &binary, const char *const buildOptions) {
+
+	cl_int status, binaryStatus;
+	const unsigned char *binaryPtr = binary.data();
+	size_t binarySize = binary.size();
+	cl_program program = clCreateProgramWithBinary(device -> context, 1, &(device -> device), &binarySize, &binaryPtr, &binaryStatus, &status);
+	if (status != CL_SUCCESS || binaryStatus != CL_SUCCESS) {
+		return NULL;
+	}
+	if (clBuildProgram(program, 1, &(device -> device), buildOptions, 0, 0) != CL_SUCCESS) {
+		clReleaseProgram(program);
+		return NULL;
+	}
+
+	return program;
+}
+
+
+/**
+ * @brief Gets the binary of a program built for only one device
+ * @param program The program
+ * @return The binary. It is empty if the device does not provide it
+ */
+static std::vector<unsigned char> programBinary(const cl_program program) {
+
+	size_t binarySize = 0;
+	std::vector<unsigned char> binary;
+	if (clGetProgramInfo(program, CL_PROGRAM_BINARY_SIZES, sizeof(size_t), &binarySize, NULL) == CL_SUCCESS && binarySize > 0) {
+		binary.resize(binarySize);
+		unsigned char *binaryPtr = binary.data();
+		if (clGetProgramInfo(program, CL_PROGRAM_BINARIES, sizeof(unsigned char *), &binaryPtr, NULL) != CL_SUCCESS) {
+			binary.clear();
+		}
+	}
+
+	return binary;
+}
+
+
+/**
+ * @brief Reads a program binary from the cache directory
+ * @param path The name of the file
+ * @param binary The binary will be stored. It is empty if the file does not exist
+ */
+static void readCachedBinary(const std::string &path, std::vector<unsigned char> &binary) {
+
+	binary.clear();
+	FILE *file = fopen(path.c_str(), "rb");
+	if (file != NULL) {
+		fseek(file, 0, SEEK_END);
+		long size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+		if (size > 0) {
+			binary.resize(size);
+			if (fread(binary.data(), 1, size, file) != (size_t) size) {
+				binary.clear();
+			}
+		}
+		fclose(file);
+	}
+}
+
+
+/**
+ * @brief Writes a program binary in the cache directory. A failure only prevents the reuse of the binary
+ *
+ * The binary is written in a temporary file which is renamed later, so the processes sharing the directory never read an incomplete binary
+ * @param cacheDir The cache directory. It is created if it does not exist
+ * @param path The name of the file
+ * @param binary The binary of the program
+ */
+static void writeCachedBinary(const std::string &cacheDir, const std::string &path, const std::vector<unsigned char> &binary) {
+
+	mkdir(cacheDir.c_str(), 0755);
+	std::string tmpPath = path + "." + std::to_string(getpid()) + ".tmp";
+	FILE *file = fopen(tmpPath.c_str(), "wb");
+	if (file != NULL) {
+		bool written = (fwrite(binary.data(), 1, binary.size(), file) == binary.size());
+		written &= (fclose(file) == 0);
+		if (!written || rename(tmpPath.c_str(), path.c_str()) != 0) {
+			remove(tmpPath.c_str());
+		}
+	}
+}
+
+
+/**
+ * @brief Builds the program of each OpenCL device
+ *
+ * The devices of the same kind (name, driver and version) share one build. The different builds are run in parallel. If a cache directory is specified, the binaries are loaded from it and the new builds are stored in it
+ * @param devices The OpenCL devices
+ * @param nDevices The number of OpenCL devices
+ * @param source The source code of the program
+ * @param buildOptions The build options of the program
+ * @param cacheDir The directory containing the program binaries. Empty to disable the cache
+ * @param programs The built program of each device will be stored
+ */
+static void buildPrograms(const CLDevice *const devices, const int nDevices, const std::string &source, const char *const buildOptions, const std::string &cacheDir, cl_program *const programs) {
+
+	std::vector<std::string> keys(nDevices);
+	std::vector<std::vector<unsigned char>> binaries(nDevices);
+	std::vector<int> firstOfKind(nDevices);
+	for (int dev = 0; dev < nDevices; ++dev) {
+		keys[dev] = programKey(devices[dev].device, source, buildOptions);
+		firstOfKind[dev] = dev;
+		for (int prev = 0; prev < dev && firstOfKind[dev] == dev; ++prev) {
+			if (keys[prev] == keys[dev]) {
+				firstOfKind[dev] = prev;
+			}
+		}
+	}
+
+	// One build of each kind of device
+	#pragma omp parallel for schedule(dynamic)
+	for (int dev = 0; dev < nDevices; ++dev) {
+		if (firstOfKind[dev] == dev) {
+			std::string path = cacheDir + "/" + keys[dev] + ".bin";
+			programs[dev] = NULL;
+			if (!cacheDir.empty()) {
+				readCachedBinary(path, binaries[dev]);
+				if (!binaries[dev].empty()) {
+					programs[dev] = programFromBinary(&devices[dev], binaries[dev], buildOptions);
+				}
+			}
+
+			// The binary does not exist or it is not valid anymore
+			if (programs[dev] == NULL) {
+				programs[dev] = programFromSource(&devices[dev], source, buildOptions);
+				binaries[dev] = programBinary(programs[dev]);
+				if (!cacheDir.empty() && !binaries[dev].empty()) {
+					writeCachedBinary(cacheDir, path, binaries[dev]);
+				}
+			}
+		}
+	}
+
+	// The rest of devices reuse the binary of their kind
+	#pragma omp parallel for schedule(dynamic)
+	for (int dev = 0; dev < nDevices; ++dev) {
+		if (firstOfKind[dev] != dev) {
+			const std::vector<unsigned char> &binary = binaries[firstOfKind[dev]];
+			programs[dev] = (binary.empty()) ? NULL : programFromBinary(&devices[dev], binary, buildOptions);
+			if (programs[dev] == NULL) {
+				programs[dev] = programFromSource(&devices[dev], source, buildOptions);
+			}
+		}
+	}
+}
+
+
+/**
+ * @brief Gets the local memory used by each slice of the packed kernel. It must match 'SLICE_BYTES' in the kernels file
+ * @param conf The structure with all configuration parameters
+ * @return The number of bytes of a slice (multiple of 16)
+ */
+static long int packedSliceBytes(const Config *const conf) {
+
+	long int bytes = ((conf -> K * conf -> nFeatures) + conf -> trNInstances) * sizeof(cl_float); // Centroids and DistCentroids buffers
+	bytes += (conf -> nFeatures + conf -> K + 4) * sizeof(cl_int); // Selected features, Samples_in_k buffer and state of the slice
+	bytes += conf -> trNInstances * sizeof(cl_uchar); // Mapping buffer
+	return ((bytes + 15) / 16) * 16;
+}
+
+
+/**
+ * @brief Gets the name of the kernel which implements a variant
+ * @param kernelVariant The variant of the kernel ('KERNEL_BASIC', 'KERNEL_REDUCTION', 'KERNEL_PACKED' or 'KERNEL_TILED')
+ * @return The name of the kernel in the kernels file
+ */
+static const char *kernelName(const int kernelVariant) {
+
+	switch (kernelVariant) {
+		case KERNEL_REDUCTION:
+			return "kmeansReduction";
+		case KERNEL_PACKED:
+			return "kmeansPacked";
+		case KERNEL_TILED:
+			return "kmeansTiled";
+		default:
+			return "kmeansGPU";
+	}
+}
+
+
+/**
+ * @brief Gets the local memory used by the kernel of a device. The packing factor of the 'KERNEL_PACKED' variant is also computed
+ * @param device The device whose kernel and work-group size are already set
+ * @param maxMemory The local memory of the device
+ * @param conf The structure with all configuration parameters
+ * @return The number of bytes of local memory used by each work-group
+ */
+static long int localMemoryUsage(CLDevice *const device, const long int maxMemory, const Config *const conf) {
+
+	long int usedMemory;
+	device -> packing = 1;
+	if (device -> kernelVariant == KERNEL_PACKED) {
+
+		// Each slice needs one work-item per instance (rounded to the preferred multiple) and its own partition of the local memory. 1024 bytes of margin
+		size_t preferredMultiple;
+		check(clGetKernelWorkGroupInfo(device -> kernel, device -> device, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(size_t), &preferredMultiple, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_WORKGROUP);
+		long int sliceBytes = packedSliceBytes(conf);
+		int bySize = device -> wiLocal / (((conf -> trNInstances + preferredMultiple - 1) / preferredMultiple) * preferredMultiple);
+		int byMemory = (maxMemory - 1024) / sliceBytes;
+		device -> packing = std::max(1, std::min(bySize, byMemory));
+		usedMemory = device -> packing * sliceBytes;
+	}
+	else if (device -> kernelVariant == KERNEL_TILED) {
+		usedMemory = conf -> nFeatures * sizeof(cl_int); // Indexes of the selected features
+		usedMemory += 2 * conf -> K * conf -> nFeatures * sizeof(cl_float); // Centroids and sums buffers
+		usedMemory += TILE_INSTANCES * sizeof(cl_uchar); // Tile of the mapping buffer
+		usedMemory += conf -> K * sizeof(cl_int); // Samples_in_k buffer
+		usedMemory += device -> wiLocal * sizeof(cl_float); // Scratch space of the reductions
+	}
+	else {
+		usedMemory = conf -> trNInstances * sizeof(cl_uchar); // Mapping buffer
+		usedMemory += conf -> K * conf -> nFeatures * sizeof(cl_float); // Centroids buffer
+		usedMemory += conf -> trNInstances * sizeof(cl_float); // DistCentroids buffer
+		usedMemory += conf -> K * sizeof(cl_int); // Samples_in_k buffer
+		if (device -> kernelVariant == KERNEL_REDUCTION) {
+			usedMemory += conf -> nFeatures * sizeof(cl_int); // Indexes of the selected features
+			usedMemory += device -> wiLocal * sizeof(cl_float); // Scratch space of the reductions
+		}
+		else {
+			usedMemory += conf -> nFeatures * sizeof(cl_uchar); // Chromosome of the individual
+		}
+	}
+
+	return usedMemory;
+}
+
+
+/**
+ * @brief Sets the arguments of the kernel of a device which do not change between launches
+ * @param device The device whose kernel, buffers and work-items are already set
+ * @param conf The structure with all configuration parameters
+ */
+static void setKernelArguments(CLDevice *const device, const Config *const conf) {
+
+	check(clSetKernelArg(device -> kernel, 0, sizeof(cl_mem), (void *)&(device -> objChromosomes)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT1);
+
+	check(clSetKernelArg(device -> kernel, 1, sizeof(cl_mem), (void *)&(device -> objSelInstances)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT2);
+
+	check(clSetKernelArg(device -> kernel, 2, sizeof(cl_mem), (void *)&(device -> objTrDataBase)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT3);
+
+	check(clSetKernelArg(device -> kernel, 5, sizeof(cl_mem), (void *)&(device -> objTransposedTrDataBase)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT6);
+
+	check(clSetKernelArg(device -> kernel, 6, sizeof(cl_mem), (void *)&(device -> objResults)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT7);
+
+	// The reduction and tiled kernels need one float of local memory for each work-item, and the packed kernel a partition for each slice
+	if (device -> kernelVariant == KERNEL_REDUCTION || device -> kernelVariant == KERNEL_TILED) {
+		check(clSetKernelArg(device -> kernel, 7, device -> wiLocal * sizeof(cl_float), NULL) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT8);
+	}
+	if (device -> kernelVariant == KERNEL_TILED) {
+		check(clSetKernelArg(device -> kernel, 8, sizeof(cl_mem), (void *)&(device -> objDistances)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT9);
+		check(clSetKernelArg(device -> kernel, 9, sizeof(cl_mem), (void *)&(device -> objMappings)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT10);
+	}
+	else if (device -> kernelVariant == KERNEL_PACKED) {
+		check(clSetKernelArg(device -> kernel, 7, device -> packing * packedSliceBytes(conf), NULL) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT8);
+		check(clSetKernelArg(device -> kernel, 8, sizeof(int), &(device -> packing)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT9);
+	}
+}
+
+
+/**
+ * @brief Gets the key of the tuned settings of a device. The settings depend on the device and on the dimensions of the database
+ * @param deviceName The name of the device
+ * @param conf The structure with all configuration parameters
+ * @return The key, with its fields separated by tabs
+ */
+static std::string tuningKey(const std::string &deviceName, const Config *const conf) {
+
+	return deviceName + "\t" + std::to_string(conf -> trNInstances) + "\t" + std::to_string(conf -> nFeatures) + "\t" + std::to_string(conf -> K);
+}
+
+
+/**
+ * @brief Reads the tuned settings of a device from the tuning file of the host
+ * @param fileName The name of the tuning file
+ * @param deviceName The name of the device
+ * @param conf The structure with all configuration parameters
+ * @param computeUnits The tuned number of compute units will be stored
+ * @param wiLocal The tuned number of local work-items will be stored
+ * @param kernelVariant The tuned kernel variant will be stored
+ * @return True if the file contains the settings of the device for the current database
+ */
+static bool readTuning(const std::string &fileName, const std::string &deviceName, const Config *const conf, int *const computeUnits, int *const wiLocal, int *const kernelVariant) {
+
+	std::ifstream file(fileName.c_str());
+	const std::string key = tuningKey(deviceName, conf) + "\t";
+	std::string line;
+	while (std::getline(file, line)) {
+		char variant[64];
+		if (line.compare(0, key.size(), key) == 0 && sscanf(line.c_str() + key.size(), "%d\t%d\t%63s", computeUnits, wiLocal, variant) == 3) {
+			for (int v = KERNEL_BASIC; v <= KERNEL_TILED; ++v) {
+				if (strcmp(variant, kernelName(v)) == 0) {
+					*kernelVariant = v;
+					return true;
+				}
+			}
+		}
+	}
+
+	return false;
+}
+
+
+/**
+ * @brief Stores the tuned settings of a device in the tuning file of the host. The previous settings of the same device and database are replaced
+ *
+ * The file is read and replaced while holding an exclusive lock on '<fileName>.lock', so concurrent processes of the host do not overwrite the settings of each other
+ * @param fileName The name of the tuning file
+ * @param deviceName The name of the device
+ * @param conf The structure with all configuration parameters
+ * @param computeUnits The tuned number of compute units
+ * @param wiLocal The tuned number of local work-items
+ * @param kernelVariant The tuned kernel variant
+ */
+static void writeTuning(const std::string &fileName, const std::string &deviceName, const Config *const conf, const int computeUnits, const int wiLocal, const int kernelVariant) {
+
+	// The processes of the host tuning at the same time are serialized, so none of them loses the settings stored by the others
+	const std::string lockName = fileName + ".lock";
+	int lock = open(lockName.c_str(), O_RDWR | O_CREAT, 0644);
+	check(lock < 0 || flock(lock, LOCK_EX) != 0, "%s\n", CL_ERROR_TUNING_OPEN);
+
+	// The settings of other devices and databases are kept
+	std::vector<std::string> lines;
+	std::ifstream oldFile(fileName.c_str());
+	const std::string key = tuningKey(deviceName, conf);
+	std::string line;
+	while (std::getline(oldFile, line)) {
+		if (!line.empty() && line.compare(0, key.size() + 1, key + "\t") != 0) {
+			lines.push_back(line);
+		}
+	}
+	oldFile.close();
+	lines.push_back(key + "\t" + std::to_string(computeUnits) + "\t" + std::to_string(wiLocal) + "\t" + kernelName(kernelVariant));
+
+	// The file is replaced at once, so other processes never read it half written
+	std::string tmpName = fileName + "." + std::to_string(getpid()) + ".tmp";
+	FILE *file = fopen(tmpName.c_str(), "w");
+	check(file == NULL, "%s\n", CL_ERROR_TUNING_OPEN);
+	for (size_t l = 0; l < lines.size(); ++l) {
+		fprintf(file, "%s\n", lines[l].c_str());
 	}
+	check(fclose(file) != 0 || rename(tmpName.c_str(), fileName.c_str()) != 0, "%s\n", CL_ERROR_TUNING_OPEN);
+
+	// Closing the lock file releases the lock
+	close(lock);
+}
+
+
+/**
+ * @brief Runs the kernel of a device over a group of individuals and measures its execution time. The first run is discarded because it includes the warm-up of the device
+ * @param device The device whose kernel arguments are already set
+ * @param nIndividuals The number of individuals stored in the device
+ * @return The execution time of the kernel in seconds
+ */
+static double timeKernel(CLDevice *const device, const int nIndividuals) {
+
+	int begin = 0;
+	check(clSetKernelArg(device -> kernel, 3, sizeof(int), &begin) != CL_SUCCESS, "%s\n", CL_ERROR_TUNING_RUN);
+	check(clSetKernelArg(device -> kernel, 4, sizeof(int), &nIndividuals) != CL_SUCCESS, "%s\n", CL_ERROR_TUNING_RUN);
+
+	double seconds = 0.0;
+	for (int run = 0; run < 2; ++run) {
+		cl_event event;
+		cl_ulong start, end;
+		check(clEnqueueNDRangeKernel(device -> commandQueue, device -> kernel, 1, NULL, &(device -> wiGlobal), &(device -> wiLocal), 0, NULL, &event) != CL_SUCCESS, "%s\n", CL_ERROR_TUNING_RUN);
+		check(clWaitForEvents(1, &event) != CL_SUCCESS, "%s\n", CL_ERROR_TUNING_RUN);
+		check(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &start, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_TUNING_RUN);
+		check(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &end, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_TUNING_RUN);
+		clReleaseEvent(event);
+		seconds = (end - start) * 1e-9;
+	}
+
+	return seconds;
 }
 
 
@@ -57,13 +532,13 @@ CLDevice *createDevices(const float *const trDataBase, const int *const selInsta
 	// OpenCL variables
 	cl_uint numPlatformsDevices;
 	cl_device_type deviceType;
-	cl_program program;
 	cl_kernel kernel;
 	cl_int status;
 
 	// Others variables
 	auto allDevices = getAllDevices();
 	CLDevice *devices = new CLDevice[conf -> nDevices + (conf -> ompThreads > 0)];
+	cl_program *programs = new cl_program[conf -> nDevices];
 
 	for (int dev = 0; dev < conf -> nDevices; ++dev) {
 
@@ -81,22 +556,6 @@ CLDevice *createDevices(const float *const trDataBase, const int *const selInsta
 				check(clGetDeviceInfo(devices[dev].device, CL_DEVICE_TYPE, sizeof(cl_device_type), &(devices[dev].deviceType), NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_TYPE);
 
 
-				/********** Device local memory usage ***********/
-
-				long int usedMemory = conf -> nFeatures * sizeof(cl_uchar); // Chromosome of the individual
-				usedMemory += conf -> trNInstances * sizeof(cl_uchar); // Mapping buffer
-				usedMemory += conf -> K * conf -> nFeatures * sizeof(cl_float); // Centroids buffer
-				usedMemory += conf -> trNInstances * sizeof(cl_float); // DistCentroids buffer
-				usedMemory += conf -> K * sizeof(cl_int); // Samples_in_k buffer
-
-				// Get the maximum local memory size
-				long int maxMemory;
-				check(clGetDeviceInfo(devices[dev].device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(long int), &maxMemory, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_MAXMEM);
-
-				// Avoid exceeding the maximum local memory available. 1024 bytes of margin
-				check(usedMemory > maxMemory - 1024, "%s:\n\tMax memory: %ld bytes\n\tAllow memory: %ld bytes\n\tUsed memory: %ld bytes\n", CL_ERROR_DEVICE_LOCALMEM, maxMemory, maxMemory - 1024, usedMemory);
-
-
 				/********** Create context ***********/
 
 				devices[dev].context = clCreateContext(NULL, 1, &(devices[dev].device), 0, 0, &status);
@@ -108,97 +567,158 @@ CLDevice *createDevices(const float *const trDataBase, const int *const selInsta
 				devices[dev].commandQueue = clCreateCommandQueue(devices[dev].context, devices[dev].device, CL_QUEUE_OUT_OF_ORDER_EXEC_MODE_ENABLE | CL_QUEUE_PROFILING_ENABLE, &status);
 				check(status != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_QUEUE);
 
+				found = true;
+				allDevices.erase(allDevices.begin() + allDev);
+			}
+		}
 
-				/********** Read the kernel file ***********/
-
-				// Open the file containing the kernels
-				std::fstream kernels(conf -> kernelsFileName.c_str(), std::fstream::in);
-				check(!kernels.is_open(), "%s\n", CL_ERROR_FILE_OPEN);
-
-				// Obtain the size
-				kernels.seekg(0, kernels.end);
-				size_t fSize = kernels.tellg();
-				kernels.seekg(0, kernels.beg);
-
-				char *kernelSource = new char[fSize];
-				kernels.read(kernelSource, fSize);
-				kernels.close();
-
-				// Create program
-				program = clCreateProgramWithSource(devices[dev].context, 1, (const char **) &kernelSource, &fSize, &status);
-				check(status != CL_SUCCESS, "%s\n", CL_ERROR_PROGRAM_BUILD);
+		check(!found, "%s\n", CL_ERROR_DEVICE_FOUND);
+	}
 
-				// Build program for the device in the context
-				char buildOptions[196];
-				sprintf(buildOptions, "-I include -D N_INSTANCES=%d -D N_FEATURES=%d -D N_OBJECTIVES=%d -D K=%d -D MAX_ITER_KMEANS=%d", conf -> trNInstances, conf -> nFeatures, conf -> nObjectives, conf -> K, conf -> maxIterKmeans);
-				if (clBuildProgram(program, 1, &(devices[dev].device), buildOptions, 0, 0) != CL_SUCCESS) {
-					char buffer[4096];
-					fprintf(stderr, "Error: Could not build the program\n");
-					check(clGetProgramBuildInfo(program, devices[dev].device, CL_PROGRAM_BUILD_LOG, sizeof(buffer), buffer, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_PROGRAM_ERRORS);
-					check(true, "%s\n", buffer);
-				}
 
-				/********** Create kernel ***********/
+	/********** Build the program of each device ***********/
 
-				const char *kernelName = (devices[dev].deviceType == CL_DEVICE_TYPE_GPU) ? "kmeansGPU" : "";
-				devices[dev].kernel = clCreateKernel(program, kernelName, &status);
-				check(status != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_BUILD);
+	if (conf -> nDevices > 0) {
 
+		// Open the file containing the kernels
+		std::fstream kernels(conf -> kernelsFileName.c_str(), std::fstream::in);
+		check(!kernels.is_open(), "%s\n", CL_ERROR_FILE_OPEN);
+		std::string kernelSource((std::istreambuf_iterator<char>(kernels)), std::istreambuf_iterator<char>());
+		kernels.close();
 
-				/******* Work-items *******/
+		char buildOptions[256];
+		sprintf(buildOptions, "-I include -D N_INSTANCES=%d -D N_FEATURES=%d -D N_OBJECTIVES=%d -D K=%d -D MAX_ITER_KMEANS=%d -D MAX_CHANGES_KMEANS=%d -D TILE_INSTANCES=%d", conf -> trNInstances, conf -> nFeatures, conf -> nObjectives, conf -> K, conf -> maxIterKmeans, (int) (conf -> kmeansTolerance * conf -> trNInstances), TILE_INSTANCES);
+		buildPrograms(devices, conf -> nDevices, kernelSource, buildOptions, conf -> programCacheDir, programs);
+	}
 
-				devices[dev].computeUnits = atoi(conf -> computeUnits[dev].c_str());
-				devices[dev].wiLocal = atoi(conf -> wiLocal[dev].c_str());
-				devices[dev].wiGlobal = devices[dev].computeUnits * devices[dev].wiLocal;
+	for (int dev = 0; dev < conf -> nDevices; ++dev) {
 
+		/********** Kernel variant and work-items ***********/
+
+		// Only the fields of the configuration left empty take the tuned settings of the host. The specified ones are always kept
+		const bool unsetVariant = (conf -> kernelVariants[dev] == KERNEL_UNSET);
+		devices[dev].program = programs[dev];
+		devices[dev].kernelVariant = (unsetVariant) ? KERNEL_BASIC : conf -> kernelVariants[dev];
+		devices[dev].computeUnits = atoi(conf -> computeUnits[dev].c_str());
+		devices[dev].wiLocal = atoi(conf -> wiLocal[dev].c_str());
+		if (unsetVariant || conf -> computeUnits[dev].empty() || conf -> wiLocal[dev].empty()) {
+			int tunedCU, tunedWI, tunedVariant;
+			if (readTuning(conf -> tuningFileName, devices[dev].deviceName, conf, &tunedCU, &tunedWI, &tunedVariant)) {
+				devices[dev].computeUnits = (conf -> computeUnits[dev].empty()) ? tunedCU : devices[dev].computeUnits;
+				devices[dev].wiLocal = (conf -> wiLocal[dev].empty()) ? tunedWI : devices[dev].wiLocal;
+				devices[dev].kernelVariant = (unsetVariant) ? tunedVariant : devices[dev].kernelVariant;
+			}
+		}
 
-				/******* Create and write the databases and centroids buffers. Create the subpopulations buffer. Set kernel arguments *******/
+		// CPU and accelerator OpenCL devices (e.g. PoCL) run the same kernel as the GPUs
+		devices[dev].kernel = clCreateKernel(devices[dev].program, kernelName(devices[dev].kernelVariant), &status);
+		check(status != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_BUILD);
+
+		// A value of 0 (or an empty field without tuned settings) selects them automatically
+		// The CPU runtimes execute the work-items of a group as a loop vectorized across the preferred multiple...
+		// ...and each barrier splits that loop, so one small work-group per core is better than the sizes used in GPUs
+		cl_uint maxCU;
+		size_t maxWorkGroup, preferredMultiple;
+		check(clGetDeviceInfo(devices[dev].device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &maxCU, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_MAXCU);
+		check(clGetKernelWorkGroupInfo(devices[dev].kernel, devices[dev].device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t), &maxWorkGroup, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_WORKGROUP);
+		check(clGetKernelWorkGroupInfo(devices[dev].kernel, devices[dev].device, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(size_t), &preferredMultiple, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_WORKGROUP);
+		if (devices[dev].computeUnits <= 0) {
+			devices[dev].computeUnits = maxCU;
+		}
+		if (devices[dev].wiLocal == 0) {
+			devices[dev].wiLocal = (devices[dev].deviceType == CL_DEVICE_TYPE_GPU) ? 256 : preferredMultiple;
+		}
+		devices[dev].wiLocal = std::min(devices[dev].wiLocal, maxWorkGroup);
+		devices[dev].wiGlobal = devices[dev].computeUnits * devices[dev].wiLocal;
+		devices[dev].throughput = 0.0;
+		devices[dev].nEvaluated = 0;
+		devices[dev].nIterKmeans = 0;
+
+
+		/********** Device local memory usage ***********/
+
+		// Get the maximum local memory size
+		long int maxMemory;
+		check(clGetDeviceInfo(devices[dev].device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(long int), &maxMemory, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_MAXMEM);
+
+		long int usedMemory = localMemoryUsage(&devices[dev], maxMemory, conf);
+
+		// The tiled kernel keeps the state of the instances in global memory, so it is used instead of aborting when the database is too large
+		if (usedMemory > maxMemory - 1024 && devices[dev].kernelVariant != KERNEL_TILED) {
+			fprintf(stderr, "Process %d: %s: Not enough local memory for the selected kernel. The tiled kernel will be used\n", conf -> mpiRank, devices[dev].deviceName.c_str());
+			clReleaseKernel(devices[dev].kernel);
+			devices[dev].kernelVariant = KERNEL_TILED;
+			devices[dev].kernel = clCreateKernel(devices[dev].program, kernelName(KERNEL_TILED), &status);
+			check(status != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_BUILD);
+			check(clGetKernelWorkGroupInfo(devices[dev].kernel, devices[dev].device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t), &maxWorkGroup, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_WORKGROUP);
+			devices[dev].wiLocal = std::min(devices[dev].wiLocal, maxWorkGroup);
+			devices[dev].wiGlobal = devices[dev].computeUnits * devices[dev].wiLocal;
+			usedMemory = localMemoryUsage(&devices[dev], maxMemory, conf);
+		}
 
-				// Create buffers
-				devices[dev].objSubpopulations = clCreateBuffer(devices[dev].context, CL_MEM_READ_WRITE, conf -> familySize * sizeof(Individual), 0, &status);
-				check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_SUBPOPS);
+		// Avoid exceeding the maximum local memory available. 1024 bytes of margin
+		check(usedMemory > maxMemory - 1024, "%s:\n\tMax memory: %ld bytes\n\tAllow memory: %ld bytes\n\tUsed memory: %ld bytes\n", CL_ERROR_DEVICE_LOCALMEM, maxMemory, maxMemory - 1024, usedMemory);
 
-				devices[dev].objTrDataBase = clCreateBuffer(devices[dev].context, CL_MEM_READ_ONLY, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), 0, &status);
-				check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_TRDB);
 
-				devices[dev].objTransposedTrDataBase = clCreateBuffer(devices[dev].context, CL_MEM_READ_ONLY, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), 0, &status);
-				check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_TTRDB);
+		/******* Create and write the databases and centroids buffers. Create the subpopulations buffer. Set kernel arguments *******/
 
-				devices[dev].objSelInstances = clCreateBuffer(devices[dev].context, CL_MEM_READ_ONLY, conf -> K * sizeof(cl_int), 0, &status);
-				check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_CENTROIDS);
+		// Create buffers
+		// Only the bit-packed chromosomes are sent and only the fitness is received
+		devices[dev].objChromosomes = clCreateBuffer(devices[dev].context, CL_MEM_READ_ONLY, conf -> familySize * packedChromosomeSize(conf), 0, &status);
+		check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_CHROMOSOMES);
 
-				// Sets kernel arguments
-				check(clSetKernelArg(devices[dev].kernel, 0, sizeof(cl_mem), (void *)&(devices[dev].objSubpopulations)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT1);
+		devices[dev].objResults = clCreateBuffer(devices[dev].context, CL_MEM_WRITE_ONLY, conf -> familySize * (conf -> nObjectives + 1) * sizeof(cl_float), 0, &status);
+		check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_RESULTS);
 
-				check(clSetKernelArg(devices[dev].kernel, 1, sizeof(cl_mem), (void *)&(devices[dev].objSelInstances)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT2);
+		// The tiled kernel stores the state of the instances of each work-group in global memory
+		devices[dev].objDistances = NULL;
+		devices[dev].objMappings = NULL;
+		if (devices[dev].kernelVariant == KERNEL_TILED) {
+			devices[dev].objDistances = clCreateBuffer(devices[dev].context, CL_MEM_READ_WRITE, devices[dev].computeUnits * conf -> trNInstances * sizeof(cl_float), 0, &status);
+			check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_SCRATCH);
 
-				check(clSetKernelArg(devices[dev].kernel, 2, sizeof(cl_mem), (void *)&(devices[dev].objTrDataBase)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT3);
+			devices[dev].objMappings = clCreateBuffer(devices[dev].context, CL_MEM_READ_WRITE, devices[dev].computeUnits * conf -> trNInstances * sizeof(cl_uchar), 0, &status);
+			check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_SCRATCH);
+		}
 
-				check(clSetKernelArg(devices[dev].kernel, 5, sizeof(cl_mem), (void *)&(devices[dev].objTransposedTrDataBase)) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_ARGUMENT6);
+		devices[dev].objTrDataBase = clCreateBuffer(devices[dev].context, CL_MEM_READ_ONLY, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), 0, &status);
+		check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_TRDB);
 
-				// Write buffers
-				check(clEnqueueWriteBuffer(devices[dev].commandQueue, devices[dev].objTrDataBase, CL_FALSE, 0, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), trDataBase, 0, NULL, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_ENQUEUE_TRDB);
-				check(clEnqueueWriteBuffer(devices[dev].commandQueue, devices[dev].objSelInstances, CL_FALSE, 0, conf -> K * sizeof(cl_int), selInstances, 0, NULL, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_ENQUEUE_CENTROIDS);
-				check(clEnqueueWriteBuffer(devices[dev].commandQueue, devices[dev].objTransposedTrDataBase, CL_FALSE, 0, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), transposedTrDataBase, 0, NULL, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_ENQUEUE_TTRDB);
+		devices[dev].objTransposedTrDataBase = clCreateBuffer(devices[dev].context, CL_MEM_READ_ONLY, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), 0, &status);
+		check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_TTRDB);
 
-				// Resources used are released
-				delete[] kernelSource;
-				clReleaseProgram(program);
+		devices[dev].objSelInstances = clCreateBuffer(devices[dev].context, CL_MEM_READ_ONLY, conf -> K * sizeof(cl_int), 0, &status);
+		check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_CENTROIDS);
 
-				found = true;
-				allDevices.erase(allDevices.begin() + allDev);
-			}
-		}
+		// Sets kernel arguments
+		setKernelArguments(&devices[dev], conf);
 
-		check(!found, "%s\n", CL_ERROR_DEVICE_FOUND);
+		// Write buffers
+		check(clEnqueueWriteBuffer(devices[dev].commandQueue, devices[dev].objTrDataBase, CL_FALSE, 0, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), trDataBase, 0, NULL, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_ENQUEUE_TRDB);
+		check(clEnqueueWriteBuffer(devices[dev].commandQueue, devices[dev].objSelInstances, CL_FALSE, 0, conf -> K * sizeof(cl_int), selInstances, 0, NULL, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_ENQUEUE_CENTROIDS);
+		check(clEnqueueWriteBuffer(devices[dev].commandQueue, devices[dev].objTransposedTrDataBase, CL_FALSE, 0, conf -> trNInstances * conf -> nFeatures * sizeof(cl_float), transposedTrDataBase, 0, NULL, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_ENQUEUE_TTRDB);
 	}
+	delete[] programs;
 
 
 	/********** Add the CPU if has been enabled in configuration ***********/
 
 	if (conf -> ompThreads > 0) {
 		devices[conf -> nDevices].deviceType = CL_DEVICE_TYPE_CPU;
+		devices[conf -> nDevices].openMP = true;
+		devices[conf -> nDevices].packing = 1;
 		devices[conf -> nDevices].computeUnits = conf -> ompThreads;
+		devices[conf -> nDevices].deviceName = "CPU (OpenMP)";
+		devices[conf -> nDevices].throughput = 0.0;
+		devices[conf -> nDevices].nEvaluated = 0;
+		devices[conf -> nDevices].nIterKmeans = 0;
+
+		// The arenas are reserved once for the whole run, one for each thread of the evaluation
+		const size_t scratchSize = evaluationScratchSize(conf);
+		devices[conf -> nDevices].scratch = new ScratchArena[conf -> ompThreads];
+		for (int t = 0; t < conf -> ompThreads; ++t) {
+			devices[conf -> nDevices].scratch[t].reserve(scratchSize);
+		}
 		++(conf -> nDevices);
 	}
 
@@ -206,6 +726,115 @@ CLDevice *createDevices(const float *const trDataBase, const int *const selInsta
 }
 
 
+/**
+ * @brief Measures the best kernel variant, compute units and local work-items of each OpenCL device and stores them in the tuning file of the host
+ *
+ * Each device evaluates a family of synthetic individuals with all the kernel variants, the multiples of its preferred work-group size and several work-groups per compute unit. The configurations which do not fit in the local memory are skipped
+ * @param devices The OpenCL devices, already created with the database of the experiment
+ * @param conf The structure with all configuration parameters
+ */
+void autotuneDevices(CLDevice *const devices, const Config *const conf) {
+
+	const int packedSize = packedChromosomeSize(conf);
+	const int nIndividuals = conf -> familySize;
+	const int cuFactors[] = {1, 2, 4}; // Work-groups for each compute unit
+	cl_int status;
+
+	// Synthetic individuals with up to 'maxFeatures' selected features. A fixed seed makes all the sweeps evaluate the same individuals
+	std::vector<unsigned char> packed(nIndividuals * packedSize, 0);
+	unsigned int seed = 12345;
+	for (int ind = 0; ind < nIndividuals; ++ind) {
+		for (int s = 0; s < conf -> maxFeatures; ++s) {
+			seed = (seed * 1103515245) + 12345;
+			int f = (seed >> 16) % conf -> nFeatures;
+			packed[(ind * packedSize) + (f >> 3)] |= 1 << (f & 7);
+		}
+	}
+
+	for (int dev = 0; dev < conf -> nDevices; ++dev) {
+		CLDevice *const device = &devices[dev];
+		if (device -> openMP) {
+			continue;
+		}
+
+		// The settings chosen by 'createDevices' are restored after the sweep
+		const cl_kernel oldKernel = device -> kernel;
+		const cl_mem oldDistances = device -> objDistances;
+		const cl_mem oldMappings = device -> objMappings;
+		const int oldVariant = device -> kernelVariant;
+		const int oldComputeUnits = device -> computeUnits;
+		const int oldPacking = device -> packing;
+		const size_t oldWiLocal = device -> wiLocal;
+		const size_t oldWiGlobal = device -> wiGlobal;
+
+		cl_uint maxCU;
+		long int maxMemory;
+		check(clGetDeviceInfo(device -> device, CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &maxCU, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_MAXCU);
+		check(clGetDeviceInfo(device -> device, CL_DEVICE_LOCAL_MEM_SIZE, sizeof(long int), &maxMemory, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_MAXMEM);
+		check(clEnqueueWriteBuffer(device -> commandQueue, device -> objChromosomes, CL_TRUE, 0, nIndividuals * packedSize, packed.data(), 0, NULL, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_TUNING_RUN);
+
+		// The state of the tiled kernel is sized for the largest number of work-groups of the sweep
+		const int maxGroups = maxCU * cuFactors[2];
+		device -> objDistances = clCreateBuffer(device -> context, CL_MEM_READ_WRITE, maxGroups * conf -> trNInstances * sizeof(cl_float), 0, &status);
+		check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_SCRATCH);
+		device -> objMappings = clCreateBuffer(device -> context, CL_MEM_READ_WRITE, maxGroups * conf -> trNInstances * sizeof(cl_uchar), 0, &status);
+		check(status != CL_SUCCESS, "%s\n", CL_ERROR_OBJECT_SCRATCH);
+
+		double bestRate = 0.0;
+		int bestVariant = -1, bestComputeUnits = 0, bestWiLocal = 0;
+		for (int variant = KERNEL_BASIC; variant <= KERNEL_TILED; ++variant) {
+			size_t maxWorkGroup, preferredMultiple;
+			device -> kernelVariant = variant;
+			device -> kernel = clCreateKernel(device -> program, kernelName(variant), &status);
+			check(status != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_BUILD);
+			check(clGetKernelWorkGroupInfo(device -> kernel, device -> device, CL_KERNEL_WORK_GROUP_SIZE, sizeof(size_t), &maxWorkGroup, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_WORKGROUP);
+			check(clGetKernelWorkGroupInfo(device -> kernel, device -> device, CL_KERNEL_PREFERRED_WORK_GROUP_SIZE_MULTIPLE, sizeof(size_t), &preferredMultiple, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_KERNEL_WORKGROUP);
+
+			for (size_t wi = std::max((size_t) 1, preferredMultiple); wi <= maxWorkGroup; wi *= 2) {
+				for (int f = 0; f < 3; ++f) {
+					device -> computeUnits = maxCU * cuFactors[f];
+					device -> wiLocal = wi;
+					device -> wiGlobal = device -> computeUnits * wi;
+					if (localMemoryUsage(device, maxMemory, conf) > maxMemory - 1024) {
+						continue;
+					}
+					setKernelArguments(device, conf);
+					double rate = nIndividuals / std::max(timeKernel(device, nIndividuals), 1e-9);
+					if (rate > bestRate) {
+						bestRate = rate;
+						bestVariant = variant;
+						bestComputeUnits = device -> computeUnits;
+						bestWiLocal = (int) wi;
+					}
+				}
+			}
+			clReleaseKernel(device -> kernel);
+		}
+
+		// Resources used are released and the settings of the device are restored
+		clReleaseMemObject(device -> objDistances);
+		clReleaseMemObject(device -> objMappings);
+		device -> kernel = oldKernel;
+		device -> objDistances = oldDistances;
+		device -> objMappings = oldMappings;
+		device -> kernelVariant = oldVariant;
+		device -> computeUnits = oldComputeUnits;
+		device -> packing = oldPacking;
+		device -> wiLocal = oldWiLocal;
+		device -> wiGlobal = oldWiGlobal;
+		setKernelArguments(device, conf);
+
+		if (bestVariant < 0) {
+			fprintf(stderr, "Process %d: %s: No configuration fits in the local memory of the device. It has not been tuned\n", conf -> mpiRank, device -> deviceName.c_str());
+		}
+		else {
+			fprintf(stderr, "Process %d: %s: %s kernel, %d compute units and %d local work-items (%.1f individuals/s). Stored in '%s'\n", conf -> mpiRank, device -> deviceName.c_str(), kernelName(bestVariant), bestComputeUnits, bestWiLocal, bestRate, conf -> tuningFileName.c_str());
+			writeTuning(conf -> tuningFileName, device -> deviceName, conf, bestComputeUnits, bestWiLocal, bestVariant);
+		}
+	}
+}
+
+
 /**
  * @brief Gets the IDs of all available OpenCL devices
  * @return A vector containing the IDs of all devices
@@ -231,14 +860,16 @@ std::vector<cl_device_id> getAllDevices() {
 	// Search devices in each platform
 	for (int i = 0; i < numPlatforms; ++i) {
 
-		// Get the number of devices of this platform
-		status = clGetDeviceIDs(platforms[i], CL_DEVICE_TYPE_GPU, 0, 0, (cl_uint*) &numPlatformsDevices);
+		numPlatformsDevices = 0;
+
+		// Get the number of devices of this platform. The CPUs and the accelerators are also able to run the kernels
+		status = clGetDeviceIDs(platforms[i], CL_EVALUATION_DEVICE_TYPES, 0, 0, (cl_uint*) &numPlatformsDevices);
 		check(status != CL_SUCCESS && status != CL_DEVICE_NOT_FOUND, "%s\n", CL_ERROR_DEVICES_NUMBER);
 
 		// Get all devices of this platform
 		if (numPlatformsDevices > 0) {
 			devices = new cl_device_id[numPlatformsDevices];
-			check(clGetDeviceIDs(platforms[i], CL_DEVICE_TYPE_GPU, numPlatformsDevices, devices, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_ID);
+			check(clGetDeviceIDs(platforms[i], CL_EVALUATION_DEVICE_TYPES, numPlatformsDevices, devices, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_ID);
 			allDevices.insert(allDevices.end(), devices, devices + numPlatformsDevices);
 			delete[] devices;
 		}
@@ -249,6 +880,28 @@ std::vector<cl_device_id> getAllDevices() {
 }
 
 
+/**
+ * @brief Gets a readable name for the type of an OpenCL device
+ * @param deviceType The type of the device
+ * @return The name of the type
+ */
+static const char *deviceTypeName(const cl_device_type deviceType) {
+
+	if (deviceType & CL_DEVICE_TYPE_GPU) {
+		return "GPU";
+	}
+	else if (deviceType & CL_DEVICE_TYPE_CPU) {
+		return "CPU";
+	}
+	else if (deviceType & CL_DEVICE_TYPE_ACCELERATOR) {
+		return "Accelerator";
+	}
+	else {
+		return "Other";
+	}
+}
+
+
 /**
  * @brief Prints a list containing the ID of all available OpenCL devices
  * @param mpiRank The MPI process number which is calling the function
@@ -264,10 +917,14 @@ void listDevices(const int mpiRank) {
 		char nameBuff[128];
 		size_t maxWorkitems[3];
 		unsigned int maxCU;
+		cl_device_type deviceType;
 		check(clGetDeviceInfo(allDevices[i], CL_DEVICE_NAME, sizeof(nameBuff), nameBuff, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_NAME);
+		check(clGetDeviceInfo(allDevices[i], CL_DEVICE_TYPE, sizeof(cl_device_type), &deviceType, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_TYPE);
 		check(clGetDeviceInfo(allDevices[i], CL_DEVICE_MAX_COMPUTE_UNITS, sizeof(cl_uint), &maxCU, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_MAXCU);
 		check(clGetDeviceInfo(allDevices[i], CL_DEVICE_MAX_WORK_ITEM_SIZES, sizeof(size_t) * 3, maxWorkitems, NULL) != CL_SUCCESS, "%s\n", CL_ERROR_DEVICE_MAXWORKITEMS);
-		devices += "\n\tDevice " + std::to_string(i) + " ->  Name: " + nameBuff + ";  Compute units: " + std::to_string(maxCU) + ";  Max Work-items: " + std::to_string(maxWorkitems[0]);
+		devices += "\n\tDevice " + std::to_string(i) + " ->  Name: " + nameBuff + ";  Type: " + deviceTypeName(deviceType) + ";  Compute units: " + std::to_string(maxCU) + ";  Max Work-items: " + std::to_string(maxWorkitems[0]);
 	}
+	devices += "\n\tCPU (OpenMP) K-means kernels: ";
+	devices += simdInstructionSet();
 	fprintf(stdout, "%s\n", devices.c_str());
 }
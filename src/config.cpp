@@ -22,6 +22,8 @@
 #include "tinyxml2.h"
 #include <mpi.h>
 #include <sstream> // stringstream...
+#include <unistd.h> // gethostname
+#include <time.h> // time
 
 using namespace tinyxml2;
 
@@ -37,6 +39,7 @@ Config::~Config() {
 		delete[] this -> devices;
 		delete[] this -> computeUnits;
 		delete[] this -> wiLocal;
+		delete[] this -> kernelVariants;
 	}
 }
 
@@ -78,6 +81,18 @@ Config::Config(const int argc, const char **argv) {
 	parser.addArg("-trnorm", false, "If the training database must be normalized or not."); // Normalization of the training database
 	parser.addArg("-ts", true, "Number of individuals competing in the tournament."); // Tournament size
 	parser.addArg("-ke", true, "Name of the file containing the kernels with the OpenCL code."); // Kernels
+	parser.addArg("-clcache", true, "Directory where the built OpenCL programs are stored to be reused."); // OpenCL program cache
+	parser.addArg("-autotune", false, "Measure the best kernel variant, compute units and work-items of each device and store them in the tuning file of the host."); // Autotuning
+	parser.addArg("-tunefile", true, "Name of the file with the tuned settings of the devices of the host."); // Tuning file
+	parser.addArg("-kvar", true, "Variant of the OpenCL kernel of each device (Basic, Reduction, Packed or Tiled). A single value is used by all the devices."); // OpenCL kernel variant
+	parser.addArg("-k", true, "Number of centroids (clusters) of K-means."); // Number of centroids
+	parser.addArg("-kalg", true, "Algorithm of K-means in the CPU evaluation (Lloyd, Hamerly or Gemm)."); // K-means algorithm
+	parser.addArg("-maxit", true, "Maximum number of iterations of K-means."); // Maximum iterations of K-means
+	parser.addArg("-ktol", true, "Maximum fraction of instances changing their cluster to consider that K-means has converged (0 stops at a fixed point)."); // K-means tolerance
+	parser.addArg("-fcache", true, "Maximum number of chromosomes stored in the fitness cache (0 to disable it)."); // Fitness cache
+	parser.addArg("-warm", true, "Maximum number of K-means partitions stored to warm-start the children from their parents (0 to disable it). Only available without OpenCL devices. The results then depend on the number of processes and threads."); // Warm start
+	parser.addArg("-seed", true, "Seed of the random number generators (a different one in each run if it is not specified)."); // Seed
+	parser.addArg("-prof", true, "Name of the file where the transfer, compute and idle time of each device will be written (profiling is disabled if it is not specified)."); // Profiling
 
 	// Parse and check the missing arguments
 	check(!parser.parse(argv, argc), "%s\n", CFG_ERROR_PARSE_ARGUMENTS);
@@ -205,6 +220,98 @@ Config::Config(const int argc, const char **argv) {
 	}
 	check(this -> tourSize < 2 || this -> tourSize > this -> subpopulationSize, "%s\n", CFG_ERROR_TOURNAMENT_SIZE);
 
+
+	////////////////////// -fcache value (disabled if it is not specified)
+	this -> fitnessCacheSize = 0;
+	if (parser.isSet("-fcache")) {
+		this -> fitnessCacheSize = parser.getValue<int>("-fcache");
+	}
+	else if (root -> FirstChildElement("FitnessCacheSize") != NULL) {
+		root -> FirstChildElement("FitnessCacheSize") -> QueryIntText(&(this -> fitnessCacheSize));
+	}
+	check(this -> fitnessCacheSize < 0, "%s\n", CFG_ERROR_FCACHE_MIN);
+
+
+	////////////////////// -warm value (0 if it is not specified)
+	this -> warmStartSize = 0;
+	if (parser.isSet("-warm")) {
+		this -> warmStartSize = parser.getValue<int>("-warm");
+	}
+	else if (root -> FirstChildElement("WarmStartSize") != NULL) {
+		root -> FirstChildElement("WarmStartSize") -> QueryIntText(&(this -> warmStartSize));
+	}
+	check(this -> warmStartSize < 0, "%s\n", CFG_ERROR_WARMSTART_MIN);
+
+
+	////////////////////// -prof value (the profiling is disabled if it is not specified)
+	this -> profileFileName = "";
+	if (parser.isSet("-prof")) {
+		this -> profileFileName = parser.getValue<char*>("-prof");
+	}
+	else if (root -> FirstChildElement("ProfileFileName") != NULL && root -> FirstChildElement("ProfileFileName") -> GetText() != NULL) {
+		this -> profileFileName = root -> FirstChildElement("ProfileFileName") -> GetText();
+	}
+
+
+	////////////////////// -seed value (the current time if it is not specified). All the processes use the seed of the master
+	this -> seed = (unsigned long long) time(NULL);
+	if (parser.isSet("-seed")) {
+		this -> seed = strtoull(parser.getValue<char*>("-seed"), NULL, 10);
+	}
+	else if (root -> FirstChildElement("Seed") != NULL && root -> FirstChildElement("Seed") -> GetText() != NULL) {
+		this -> seed = strtoull(root -> FirstChildElement("Seed") -> GetText(), NULL, 10);
+	}
+	MPI::COMM_WORLD.Bcast(&(this -> seed), 1, MPI::UNSIGNED_LONG_LONG, 0);
+
+
+	////////////////////// -k value (3 if it is not specified)
+	this -> K = 3;
+	if (parser.isSet("-k")) {
+		this -> K = parser.getValue<int>("-k");
+	}
+	else if (root -> FirstChildElement("NCentroids") != NULL) {
+		root -> FirstChildElement("NCentroids") -> QueryIntText(&(this -> K));
+	}
+	check(this -> K < 2 || this -> K > 255 || this -> K > this -> trNInstances, "%s\n", CFG_ERROR_CENTROIDS_RANGE);
+
+
+	////////////////////// -kalg value (Lloyd if it is not specified)
+	std::string kmeansAlgorithm = "Lloyd";
+	if (parser.isSet("-kalg")) {
+		kmeansAlgorithm = parser.getValue<char*>("-kalg");
+	}
+	else if (root -> FirstChildElement("KmeansAlgorithm") != NULL && root -> FirstChildElement("KmeansAlgorithm") -> GetText() != NULL) {
+		kmeansAlgorithm = root -> FirstChildElement("KmeansAlgorithm") -> GetText();
+	}
+	check(kmeansAlgorithm != "Lloyd" && kmeansAlgorithm != "Hamerly" && kmeansAlgorithm != "Gemm", "%s\n", CFG_ERROR_KALG_UNKNOWN);
+	this -> kmeansAlgorithm = (kmeansAlgorithm == "Hamerly") ? KMEANS_HAMERLY : (kmeansAlgorithm == "Gemm") ? KMEANS_GEMM : KMEANS_LLOYD;
+
+
+	////////////////////// -maxit value (20 if it is not specified)
+	this -> maxIterKmeans = 20;
+	if (parser.isSet("-maxit")) {
+		this -> maxIterKmeans = parser.getValue<int>("-maxit");
+	}
+	else if (root -> FirstChildElement("MaxIterKmeans") != NULL) {
+		root -> FirstChildElement("MaxIterKmeans") -> QueryIntText(&(this -> maxIterKmeans));
+	}
+	check(this -> maxIterKmeans < 1, "%s\n", CFG_ERROR_MAXITER_MIN);
+
+
+	////////////////////// -ktol value (0 if it is not specified)
+	this -> kmeansTolerance = 0.0f;
+	if (parser.isSet("-ktol")) {
+		this -> kmeansTolerance = parser.getValue<float>("-ktol");
+	}
+	else if (root -> FirstChildElement("KmeansTolerance") != NULL) {
+		root -> FirstChildElement("KmeansTolerance") -> QueryFloatText(&(this -> kmeansTolerance));
+	}
+	check(this -> kmeansTolerance < 0.0f || this -> kmeansTolerance > 1.0f, "%s\n", CFG_ERROR_KTOL_RANGE);
+
+
+	////////////////////// -autotune value
+	this -> autotune = parser.isSet("-autotune");
+
 	if (rank > 0 || (rank == 0 && size == 1)) {
 
 		////////////////////// Devices number
@@ -225,37 +332,86 @@ Config::Config(const int argc, const char **argv) {
 			this -> nDevices = std::min(this -> nDevices, split(option, this -> devices));
 
 
-			////////////////////// Compute Units
-			option = parent -> NextSiblingElement("ComputeUnits") -> GetText();
-			check(split(option, this -> computeUnits) < this -> nDevices, "%s\n", CFG_ERROR_CU_LOWER);
+			////////////////////// Compute Units (the tuned values of the host are used if it is empty)
+			if (parent -> NextSiblingElement("ComputeUnits") -> GetText() == NULL) {
+				this -> computeUnits = new std::string[this -> nDevices];
+			}
+			else {
+				option = parent -> NextSiblingElement("ComputeUnits") -> GetText();
+				check(split(option, this -> computeUnits) < this -> nDevices, "%s\n", CFG_ERROR_CU_LOWER);
+			}
 
 
-			////////////////////// Local work-items
-			option = parent -> NextSiblingElement("WiLocal") -> GetText();
-			check(split(option, this -> wiLocal) < this -> nDevices, "%s\n", CFG_ERROR_WI_LOWER);
+			////////////////////// Local work-items (the tuned values of the host are used if it is empty)
+			if (parent -> NextSiblingElement("WiLocal") -> GetText() == NULL) {
+				this -> wiLocal = new std::string[this -> nDevices];
+			}
+			else {
+				option = parent -> NextSiblingElement("WiLocal") -> GetText();
+				check(split(option, this -> wiLocal) < this -> nDevices, "%s\n", CFG_ERROR_WI_LOWER);
+			}
 
 
 			////////////////////// -ke value
 			this -> kernelsFileName = (parser.isSet("-ke")) ? parser.getValue<char*>("-ke") : parent -> NextSiblingElement("KernelsFileName") -> GetText();
+
+
+			////////////////////// -clcache value (the cache is disabled if it is not specified)
+			this -> programCacheDir = "";
+			if (parser.isSet("-clcache")) {
+				this -> programCacheDir = parser.getValue<char*>("-clcache");
+			}
+			else if (parent -> NextSiblingElement("ProgramCacheDir") != NULL && parent -> NextSiblingElement("ProgramCacheDir") -> GetText() != NULL) {
+				this -> programCacheDir = parent -> NextSiblingElement("ProgramCacheDir") -> GetText();
+			}
+
+
+			////////////////////// -tunefile value (a file for each host if it is not specified)
+			if (parser.isSet("-tunefile")) {
+				this -> tuningFileName = parser.getValue<char*>("-tunefile");
+			}
+			else if (parent -> NextSiblingElement("TuningFileName") != NULL && parent -> NextSiblingElement("TuningFileName") -> GetText() != NULL) {
+				this -> tuningFileName = parent -> NextSiblingElement("TuningFileName") -> GetText();
+			}
+			else {
+				char hostName[256] = "localhost";
+				gethostname(hostName, sizeof(hostName) - 1);
+				this -> tuningFileName = std::string("tuning_") + hostName + ".txt";
+			}
+
+
+			////////////////////// -kvar value (Basic if it is not specified, unless the host has tuned settings for the device). A single value is used by all the devices
+			option = "";
+			if (parser.isSet("-kvar")) {
+				option = parser.getValue<char*>("-kvar");
+			}
+			else if (parent -> NextSiblingElement("KernelVariant") != NULL && parent -> NextSiblingElement("KernelVariant") -> GetText() != NULL) {
+				option = parent -> NextSiblingElement("KernelVariant") -> GetText();
+			}
+			std::string *variants;
+			int nVariants = split(option, variants);
+			check(nVariants > 1 && nVariants < this -> nDevices, "%s\n", CFG_ERROR_KVAR_LOWER);
+			this -> kernelVariants = new int[this -> nDevices];
+			for (int dev = 0; dev < this -> nDevices; ++dev) {
+				std::string variant = (nVariants == 0) ? "" : variants[(nVariants == 1) ? 0 : dev];
+				check(!variant.empty() && variant != "Basic" && variant != "Reduction" && variant != "Packed" && variant != "Tiled", "%s\n", CFG_ERROR_KVAR_UNKNOWN);
+				this -> kernelVariants[dev] = (variant.empty()) ? KERNEL_UNSET : (variant == "Basic") ? KERNEL_BASIC : (variant == "Packed") ? KERNEL_PACKED : (variant == "Tiled") ? KERNEL_TILED : KERNEL_REDUCTION;
+			}
+			delete[] variants;
 		}
 
 
 		////////////////////// CPU threads value
 		parent -> NextSiblingElement("CpuThreads") -> QueryIntText(&(this -> ompThreads));
 		check(this -> ompThreads < 0 || (this -> ompThreads == 0 && this -> nDevices == 0), "%s\n", CFG_ERROR_THREADS_MIN);
+
+		// The OpenCL kernels always start K-means from the initial centroids, so they would ignore the partitions of the parents
+		check(this -> warmStartSize > 0 && this -> nDevices > 0, "%s\n", CFG_ERROR_WARMSTART_OPENCL);
 	}
 
 
 	/************ Set and get the internal parameters ***********/
 
-	////////////////////// Number of centroids for K-means algorithm
-	this -> K = 3;
-
-
-	////////////////////// Maximum iterations for K-means algorithm
-	this -> maxIterKmeans = 20;
-
-
 	////////////////////// The size of the pool (the half of the subpopulation size)
 	this -> poolSize = this -> subpopulationSize >> 1;
 
@@ -17,62 +17,25 @@
 
 /*********************************** Defines *********************************/
 
-/**
- * @brief Structure containing the Individual's parameters
- */
-typedef struct Individual {
-
-
-	/**
-	 * @brief Vector denoting the selected features
-	 *
-	 * Values: Zeros or ones
-	 */
-	unsigned char chromosome[N_FEATURES];
-
-
-	/**
-	 * @brief Individual fitness for the multi-objective functions
-	 *
-	 * Values: Each position contains an objective function
-	 */
-	float fitness[N_OBJECTIVES];
-
-
-	/**
-	 * @brief Crowding distance of the individual
-	 *
-	 * The values are positives or infinites
-	 */
-	float crowding;
-
-
-	/**
-	 * @brief Range of the individual (Pareto front)
-	 */
-	int rank;
-
-
-	/**
-	 * @brief Number of selected features
-	 */
-	int nSelFeatures;
-
-} Individual;
+#define PACKED_CHROMOSOME ((N_FEATURES + 7) / 8) // Bytes of a bit-packed chromosome
+#define RESULT_STRIDE (N_OBJECTIVES + 1) // Results of each individual: its fitness and its number of K-means iterations
+#define SLICE_STATE 4 // Changes, selected features, convergence and iterations of the individual of a slice
+#define SLICE_BYTES (((((K * N_FEATURES) + N_INSTANCES) * 4) + ((N_FEATURES + K + SLICE_STATE) * 4) + N_INSTANCES + 15) / 16 * 16) // Local memory of a slice (multiple of 16 bytes)
 
 /********************************* OpenCL Kernels ********************************/
 
 
 /**
  * @brief Computes the K-means algorithm in a OpenCL GPU device
- * @param subpop OpenCL object which contains the current subpopulation. The object is stored in global memory
+ * @param chromosomes OpenCL object which contains the bit-packed chromosomes of the current subpopulation ('PACKED_CHROMOSOME' bytes each one). The object is stored in global memory
  * @param selInstances OpenCL object which contains the instances choosen as initial centroids. The object is stored in constant memory
  * @param trDataBase OpenCL object which contains the training database. The object is stored in global memory
  * @param begin The first individual to be evaluated
  * @param end The 'end-1' position is the last individual to be evaluated
  * @param transposedDataBase OpenCL object which contains the transposed training database. The object is stored in global memory
+ * @param results OpenCL object where the fitness and the number of K-means iterations of each individual will be stored ('RESULT_STRIDE' elements each one). The object is stored in global memory
  */
-__kernel void kmeansGPU(__global struct Individual *subpop, __constant int *restrict selInstances, __global float *restrict trDataBase, const int begin, const int end, __global float *restrict transposedDataBase) {
+__kernel void kmeansGPU(__global uchar *restrict chromosomes, __constant int *restrict selInstances, __global float *restrict trDataBase, const int begin, const int end, __global float *restrict transposedDataBase, __global float *restrict results) {
 
 	uint localId = get_local_id(0);
 	uint localSize = get_local_size(0);
@@ -87,8 +50,9 @@ __kernel void kmeansGPU(__global struct Individual *subpop, __constant int *rest
 	__local float centroids_l[K * N_FEATURES];
 	__local float distCentroids[N_INSTANCES];
 	__local int samples_in_k[K];
+	__local int changes;
+	bool converged;
 
-	event_t eventInd;
 	event_t eventCentr;
 
 
@@ -100,31 +64,38 @@ __kernel void kmeansGPU(__global struct Individual *subpop, __constant int *rest
 			async_work_group_copy(centroids_l + (N_FEATURES * k), trDataBase + (selInstances[k] * N_FEATURES), N_FEATURES, eventCentr);
 		}
 
-		// The individual is cached to local memory for improve performance
-		eventInd = async_work_group_copy(chromosome, subpop[ind].chromosome, N_FEATURES, 0);
+		// The individual is unpacked to local memory for improve performance
+		__global uchar *packed = chromosomes + (ind * PACKED_CHROMOSOME);
+		for (int f = localId; f < N_FEATURES; f += localSize) {
+			chromosome[f] = (packed[f >> 3] >> (f & 7)) & 1;
+		}
 
 		// Initialize the mapping table
 		for (int i = localId; i < N_INSTANCES; i += localSize) {
 			mapping[i] = 0;
 		}
 
-		//converged = false;
+		converged = false;
 
 		// Syncpoint
-		wait_group_events(1, &eventInd);
+		barrier(CLK_LOCAL_MEM_FENCE);
 		wait_group_events(1, &eventCentr);
 
 
 		/******************** Convergence process *********************/
 
-		// To avoid poor performance, 'MAX_ITER_KMEANS' iterations are executed
-		for (int maxIter = 0; maxIter < MAX_ITER_KMEANS/* && !converged*/; ++maxIter) {
+		// K-means stops when it converges or after 'MAX_ITER_KMEANS' iterations
+		int maxIter;
+		for (maxIter = 0; maxIter < MAX_ITER_KMEANS && !converged; ++maxIter) {
 
 			barrier(CLK_LOCAL_MEM_FENCE);
 
 			for (int k = localId; k < K; k += localSize) {
 				samples_in_k[k] = 0;
 			}
+			if (localId == 0) {
+				changes = 0;
+			}
 
 			// Syncpoint
 			barrier(CLK_LOCAL_MEM_FENCE);
@@ -153,14 +124,18 @@ __kernel void kmeansGPU(__global struct Individual *subpop, __constant int *rest
 
 				if (mapping[i] != selectCentroid) {
 					mapping[i] = selectCentroid;
+					atomic_inc(&changes);
 				}
 			}
 
 			// Syncpoint
 			barrier(CLK_LOCAL_MEM_FENCE);
 
+			// With a null tolerance, the centroids would not move anymore (fixed point). All work-items take the same decision
+			converged = (maxIter > 0 && changes <= MAX_CHANGES_KMEANS);
+
 			// Update the position of the centroids
-			for (int kf = localId; kf < totalCoord; kf += localSize) {
+			for (int kf = localId; kf < totalCoord && !converged; kf += localSize) {
 				int k = kf / N_FEATURES;
 				int f = kf - (k * N_FEATURES); // kf % N_FEATURES
 				if (chromosome[f] && samples_in_k[k] > 0) {
@@ -202,10 +177,630 @@ __kernel void kmeansGPU(__global struct Individual *subpop, __constant int *rest
 			}
 
 			// First objective function (Within-cluster sum of squares (WCSS))
-			subpop[ind].fitness[0] = sumWithin;//printf("IND %d\n", ind);printf("%f\n", sumWithin);
+			results[(ind * RESULT_STRIDE)] = sumWithin;
+
+			// Second objective function (Inter-cluster sum of squares (ICSS))
+			results[(ind * RESULT_STRIDE) + 1] = sumInter;
+
+			// Number of executed iterations
+			results[(ind * RESULT_STRIDE) + N_OBJECTIVES] = maxIter;
+		}
+
+		// Syncpoint
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+}
+
+
+/**
+ * @brief Adds a value of each work-item of the work-group with a tree reduction in local memory. All the work-items must call it
+ * @param value The value of the work-item
+ * @param scratch Local memory with one element for each work-item
+ * @return The sum of the values of all the work-items
+ */
+float reduceSum(const float value, __local float *scratch) {
+
+	uint localId = get_local_id(0);
+	uint active = get_local_size(0);
+
+	scratch[localId] = value;
+	barrier(CLK_LOCAL_MEM_FENCE);
+
+	// The work-group size may not be a power of two
+	while (active > 1) {
+		uint half = (active + 1) >> 1;
+		if (localId + half < active) {
+			scratch[localId] += scratch[localId + half];
+		}
+		barrier(CLK_LOCAL_MEM_FENCE);
+		active = half;
+	}
+
+	float sum = scratch[0];
+
+	// The scratch space can be reused after the call
+	barrier(CLK_LOCAL_MEM_FENCE);
+	return sum;
+}
+
+
+/**
+ * @brief Computes the K-means algorithm in a OpenCL device. All the work-items of the group take part in the centroid update and in the fitness sums
+ *
+ * Only the selected features are stored in the centroids, and all the accesses to the database (assignment and update) are done on the transposed database, so consecutive work-items read consecutive instances
+ * @param chromosomes OpenCL object which contains the bit-packed chromosomes of the current subpopulation ('PACKED_CHROMOSOME' bytes each one). The object is stored in global memory
+ * @param selInstances OpenCL object which contains the instances choosen as initial centroids. The object is stored in constant memory
+ * @param trDataBase OpenCL object which contains the training database. The object is stored in global memory
+ * @param begin The first individual to be evaluated
+ * @param end The 'end-1' position is the last individual to be evaluated
+ * @param transposedDataBase OpenCL object which contains the transposed training database. The object is stored in global memory
+ * @param results OpenCL object where the fitness and the number of K-means iterations of each individual will be stored ('RESULT_STRIDE' elements each one). The object is stored in global memory
+ * @param scratch Local memory for the reductions (one float for each work-item)
+ */
+__kernel void kmeansReduction(__global uchar *restrict chromosomes, __constant int *restrict selInstances, __global float *restrict trDataBase, const int begin, const int end, __global float *restrict transposedDataBase, __global float *restrict results, __local float *scratch) {
+
+	uint localId = get_local_id(0);
+	uint localSize = get_local_size(0);
+	uint groupId = get_group_id(0);
+	uint numGroups = get_num_groups(0);
+
+	// The individual is cached into local memory to improve performance
+	__local int selFeatures[N_FEATURES];
+	__local uchar mapping[N_INSTANCES];
+	__local float centroids_l[K * N_FEATURES];
+	__local float distCentroids[N_INSTANCES];
+	__local int samples_in_k[K];
+	__local int changes;
+	__local int nSelFeatures;
+	bool converged;
+
+
+	// Each work-group compute an individual (master-slave as a deck algorithm)
+	for (int ind = begin + groupId; ind < end; ind += numGroups) {
+
+		// Dense list with the indexes of the selected features
+		if (localId == 0) {
+			__global uchar *packed = chromosomes + (ind * PACKED_CHROMOSOME);
+			int nSel = 0;
+			for (int f = 0; f < N_FEATURES; ++f) {
+				if ((packed[f >> 3] >> (f & 7)) & 1) {
+					selFeatures[nSel++] = f;
+				}
+			}
+			nSelFeatures = nSel;
+		}
+
+		// Initialize the mapping table
+		for (int i = localId; i < N_INSTANCES; i += localSize) {
+			mapping[i] = 0;
+		}
+
+		// Syncpoint
+		barrier(CLK_LOCAL_MEM_FENCE);
+		const int nSel = nSelFeatures;
+
+		// The centroids will have the selected features of the individual ('nSel' coordinates each one)
+		for (int kj = localId; kj < K * nSel; kj += localSize) {
+			int k = kj / nSel;
+			int j = kj - (k * nSel);
+			centroids_l[kj] = trDataBase[(selInstances[k] * N_FEATURES) + selFeatures[j]];
+		}
+
+		converged = false;
+
+
+		/******************** Convergence process *********************/
+
+		// K-means stops when it converges or after 'MAX_ITER_KMEANS' iterations
+		int maxIter;
+		for (maxIter = 0; maxIter < MAX_ITER_KMEANS && !converged; ++maxIter) {
+
+			barrier(CLK_LOCAL_MEM_FENCE);
+
+			for (int k = localId; k < K; k += localSize) {
+				samples_in_k[k] = 0;
+			}
+			if (localId == 0) {
+				changes = 0;
+			}
+
+			// Syncpoint
+			barrier(CLK_LOCAL_MEM_FENCE);
+
+			// Calculate all distances (Euclidean distance) between each instance and the centroids
+			for (int i = localId; i < N_INSTANCES; i += localSize) {
+				float minDist = INFINITY;
+				int selectCentroid = 0;
+				for (int k = 0; k < K; ++k) {
+					float dist = 0.0f;
+					for (int j = 0; j < nSel; ++j) {
+						float dif = transposedDataBase[(N_INSTANCES * selFeatures[j]) + i] - centroids_l[(k * nSel) + j];
+						dist = mad(dif, dif, dist);
+					}
+
+					if (dist < minDist) {
+						minDist = dist;
+						selectCentroid = k;
+					}
+				}
+
+				distCentroids[i] = minDist;
+				atomic_inc(&samples_in_k[selectCentroid]);
+
+				if (mapping[i] != selectCentroid) {
+					mapping[i] = selectCentroid;
+					atomic_inc(&changes);
+				}
+			}
+
+			// Syncpoint
+			barrier(CLK_LOCAL_MEM_FENCE);
+
+			// With a null tolerance, the centroids would not move anymore (fixed point). All work-items take the same decision
+			converged = (maxIter > 0 && changes <= MAX_CHANGES_KMEANS);
+
+			// Update the position of the centroids. Each column of the database is read once and...
+			// ...the partial sums of the work-items are reduced for each centroid
+			for (int j = 0; j < nSel && !converged; ++j) {
+				__global float *column = transposedDataBase + (N_INSTANCES * selFeatures[j]);
+				float partial[K];
+				for (int k = 0; k < K; ++k) {
+					partial[k] = 0.0f;
+				}
+				for (int i = localId; i < N_INSTANCES; i += localSize) {
+					partial[mapping[i]] += column[i];
+				}
+				for (int k = 0; k < K; ++k) {
+					float sum = reduceSum(partial[k], scratch);
+					if (localId == 0 && samples_in_k[k] > 0) {
+						centroids_l[(k * nSel) + j] = sum / samples_in_k[k];
+					}
+				}
+			}
+		}
+
+		// Syncpoint
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+
+		/************ Minimize the within-cluster and maximize Inter-cluster sum of squares (WCSS and ICSS) *************/
+
+		// Within-cluster
+		float partial = 0.0f;
+		for (int i = localId; i < N_INSTANCES; i += localSize) {
+			partial += sqrt(distCentroids[i]);
+		}
+		float sumWithin = reduceSum(partial, scratch);
+
+		// Inter-cluster. Each work-item computes the distance of some pairs of centroids
+		partial = 0.0f;
+		for (int pair = localId; pair < K * K; pair += localSize) {
+			int k1 = pair / K;
+			int k2 = pair - (k1 * K);
+			if (k2 > k1) {
+				float sum = 0.0f;
+				for (int j = 0; j < nSel; ++j) {
+					float dif = centroids_l[(k1 * nSel) + j] - centroids_l[(k2 * nSel) + j];
+					sum += dif * dif;
+				}
+				partial += sqrt(sum);
+			}
+		}
+		float sumInter = reduceSum(partial, scratch);
+
+		if (localId == 0) {
+
+			// First objective function (Within-cluster sum of squares (WCSS))
+			results[(ind * RESULT_STRIDE)] = sumWithin;
 
 			// Second objective function (Inter-cluster sum of squares (ICSS))
-			subpop[ind].fitness[1] = sumInter;//printf("%f\n", sumInter);
+			results[(ind * RESULT_STRIDE) + 1] = sumInter;
+
+			// Number of executed iterations
+			results[(ind * RESULT_STRIDE) + N_OBJECTIVES] = maxIter;
+		}
+
+		// Syncpoint
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+}
+
+
+/**
+ * @brief Computes the K-means algorithm in a OpenCL device evaluating several individuals in each work-group
+ *
+ * The work-group is split in 'packing' slices of work-items, and each slice evaluates an individual in its own partition of the local memory. It avoids the idle work-items of the other kernels when the database has less instances than the work-group size
+ * @param chromosomes OpenCL object which contains the bit-packed chromosomes of the current subpopulation ('PACKED_CHROMOSOME' bytes each one). The object is stored in global memory
+ * @param selInstances OpenCL object which contains the instances choosen as initial centroids. The object is stored in constant memory
+ * @param trDataBase OpenCL object which contains the training database. The object is stored in global memory
+ * @param begin The first individual to be evaluated
+ * @param end The 'end-1' position is the last individual to be evaluated
+ * @param transposedDataBase OpenCL object which contains the transposed training database. The object is stored in global memory
+ * @param results OpenCL object where the fitness and the number of K-means iterations of each individual will be stored ('RESULT_STRIDE' elements each one). The object is stored in global memory
+ * @param pool Local memory with the partitions of the slices ('SLICE_BYTES' each one)
+ * @param packing The number of individuals evaluated at the same time by a work-group
+ */
+__kernel void kmeansPacked(__global uchar *restrict chromosomes, __constant int *restrict selInstances, __global float *restrict trDataBase, const int begin, const int end, __global float *restrict transposedDataBase, __global float *restrict results, __local uchar *pool, const int packing) {
+
+	uint localId = get_local_id(0);
+	uint groupId = get_group_id(0);
+	uint numGroups = get_num_groups(0);
+	uint sliceSize = get_local_size(0) / packing;
+	uint slice = localId / sliceSize;
+	uint sliceId = localId - (slice * sliceSize);
+
+	// The remaining work-items of the division only take part in the barriers
+	bool idle = (slice >= packing);
+
+	// Partition of the local memory of the slice
+	__local float *centroids_l = (__local float *) (pool + ((idle ? 0 : slice) * SLICE_BYTES));
+	__local float *distCentroids = centroids_l + (K * N_FEATURES);
+	__local int *selFeatures = (__local int *) (distCentroids + N_INSTANCES);
+	__local int *samples_in_k = selFeatures + N_FEATURES;
+	__local int *state = samples_in_k + K; // Changes, selected features, convergence and iterations
+	__local uchar *mapping = (__local uchar *) (state + SLICE_STATE);
+	__local int anyRunning;
+
+
+	// Each work-group computes 'packing' individuals at the same time (master-slave as a deck algorithm)
+	for (int first = begin + (groupId * packing); first < end; first += numGroups * packing) {
+		int ind = first + slice;
+		bool active = !idle && ind < end;
+
+		// Dense list with the indexes of the selected features
+		if (active && sliceId == 0) {
+			__global uchar *packed = chromosomes + (ind * PACKED_CHROMOSOME);
+			int nSel = 0;
+			for (int f = 0; f < N_FEATURES; ++f) {
+				if ((packed[f >> 3] >> (f & 7)) & 1) {
+					selFeatures[nSel++] = f;
+				}
+			}
+			state[1] = nSel;
+			state[2] = 0;
+			state[3] = 0;
+		}
+
+		// Initialize the mapping table
+		for (int i = sliceId; active && i < N_INSTANCES; i += sliceSize) {
+			mapping[i] = 0;
+		}
+
+		// Syncpoint
+		barrier(CLK_LOCAL_MEM_FENCE);
+		const int nSel = (active) ? state[1] : 0;
+
+		// The centroids will have the selected features of the individual ('nSel' coordinates each one)
+		for (int kj = sliceId; kj < K * nSel; kj += sliceSize) {
+			int k = kj / nSel;
+			int j = kj - (k * nSel);
+			centroids_l[kj] = trDataBase[(selInstances[k] * N_FEATURES) + selFeatures[j]];
+		}
+
+
+		/******************** Convergence process *********************/
+
+		// The slices converge in different iterations, but the barriers must be reached by all the work-items...
+		// ...so the work-group iterates until all of its individuals have converged
+		for (int iter = 0; iter < MAX_ITER_KMEANS; ++iter) {
+
+			barrier(CLK_LOCAL_MEM_FENCE);
+			bool running = active && !state[2];
+
+			if (running) {
+				for (int k = sliceId; k < K; k += sliceSize) {
+					samples_in_k[k] = 0;
+				}
+				if (sliceId == 0) {
+					state[0] = 0;
+				}
+			}
+			if (localId == 0) {
+				anyRunning = 0;
+			}
+
+			// Syncpoint
+			barrier(CLK_LOCAL_MEM_FENCE);
+
+			// Calculate all distances (Euclidean distance) between each instance and the centroids
+			for (int i = sliceId; running && i < N_INSTANCES; i += sliceSize) {
+				float minDist = INFINITY;
+				int selectCentroid = 0;
+				for (int k = 0; k < K; ++k) {
+					float dist = 0.0f;
+					for (int j = 0; j < nSel; ++j) {
+						float dif = transposedDataBase[(N_INSTANCES * selFeatures[j]) + i] - centroids_l[(k * nSel) + j];
+						dist = mad(dif, dif, dist);
+					}
+
+					if (dist < minDist) {
+						minDist = dist;
+						selectCentroid = k;
+					}
+				}
+
+				distCentroids[i] = minDist;
+				atomic_inc(&samples_in_k[selectCentroid]);
+
+				if (mapping[i] != selectCentroid) {
+					mapping[i] = selectCentroid;
+					atomic_inc(&state[0]);
+				}
+			}
+
+			// Syncpoint
+			barrier(CLK_LOCAL_MEM_FENCE);
+
+			// With a null tolerance, the centroids would not move anymore (fixed point)
+			if (running && sliceId == 0) {
+				state[2] = (iter > 0 && state[0] <= MAX_CHANGES_KMEANS);
+				state[3] = iter + 1;
+				if (!state[2]) {
+					anyRunning = 1;
+				}
+			}
+
+			// Syncpoint
+			barrier(CLK_LOCAL_MEM_FENCE);
+
+			// Update the position of the centroids
+			for (int kj = sliceId; running && !state[2] && kj < K * nSel; kj += sliceSize) {
+				int k = kj / nSel;
+				int j = kj - (k * nSel);
+				if (samples_in_k[k] > 0) {
+					__global float *column = transposedDataBase + (N_INSTANCES * selFeatures[j]);
+					float sum = 0.0f;
+					for (int i = 0; i < N_INSTANCES; ++i) {
+						sum += (mapping[i] == k) ? column[i] : 0;
+					}
+					centroids_l[kj] = sum / samples_in_k[k];
+				}
+			}
+
+			// All the work-items take the same decision
+			if (!anyRunning) {
+				break;
+			}
+		}
+
+		// Syncpoint
+		barrier(CLK_LOCAL_MEM_FENCE);
+
+
+		/************ Minimize the within-cluster and maximize Inter-cluster sum of squares (WCSS and ICSS) *************/
+
+		if (active && sliceId == 0) {
+			float sumWithin = 0.0f;
+			float sumInter = 0.0f;
+
+			// Within-cluster
+			for (int i = 0; i < N_INSTANCES; ++i) {
+				sumWithin += sqrt(distCentroids[i]);
+			}
+
+			// Inter-cluster
+			for (int k1 = 0; k1 < K; ++k1) {
+				for (int k2 = k1 + 1; k2 < K; ++k2) {
+					float sum = 0.0f;
+					for (int j = 0; j < nSel; ++j) {
+						float dif = centroids_l[(k1 * nSel) + j] - centroids_l[(k2 * nSel) + j];
+						sum += dif * dif;
+					}
+					sumInter += sqrt(sum);
+				}
+			}
+
+			// First objective function (Within-cluster sum of squares (WCSS))
+			results[(ind * RESULT_STRIDE)] = sumWithin;
+
+			// Second objective function (Inter-cluster sum of squares (ICSS))
+			results[(ind * RESULT_STRIDE) + 1] = sumInter;
+
+			// Number of executed iterations
+			results[(ind * RESULT_STRIDE) + N_OBJECTIVES] = state[3];
+		}
+
+		// Syncpoint
+		barrier(CLK_LOCAL_MEM_FENCE);
+	}
+}
+
+
+/**
+ * @brief Computes the K-means algorithm in a OpenCL device keeping the state of the instances in global memory
+ *
+ * The mapping table and the distances of each work-group are stored in global memory, and the mapping table is cached in local memory by tiles of 'TILE_INSTANCES' instances (set by the host) during the centroid update. The local memory used does not depend on the number of instances, so it is used with the databases which do not fit in the local memory of the device
+ * @param chromosomes OpenCL object which contains the bit-packed chromosomes of the current subpopulation ('PACKED_CHROMOSOME' bytes each one). The object is stored in global memory
+ * @param selInstances OpenCL object which contains the instances choosen as initial centroids. The object is stored in constant memory
+ * @param trDataBase OpenCL object which contains the training database. The object is stored in global memory
+ * @param begin The first individual to be evaluated
+ * @param end The 'end-1' position is the last individual to be evaluated
+ * @param transposedDataBase OpenCL object which contains the transposed training database. The object is stored in global memory
+ * @param results OpenCL object where the fitness and the number of K-means iterations of each individual will be stored ('RESULT_STRIDE' elements each one). The object is stored in global memory
+ * @param scratch Local memory for the reductions (one float for each work-item)
+ * @param distances OpenCL object where each work-group stores the distance of each instance to its nearest centroid ('N_INSTANCES' elements for each work-group). The object is stored in global memory
+ * @param mappings OpenCL object where each work-group stores the nearest centroid of each instance ('N_INSTANCES' elements for each work-group). The object is stored in global memory
+ */
+__kernel void kmeansTiled(__global uchar *restrict chromosomes, __constant int *restrict selInstances, __global float *restrict trDataBase, const int begin, const int end, __global float *restrict transposedDataBase, __global float *restrict results, __local float *scratch, __global float *restrict distances, __global uchar *restrict mappings) {
+
+	uint localId = get_local_id(0);
+	uint localSize = get_local_size(0);
+	uint groupId = get_group_id(0);
+	uint numGroups = get_num_groups(0);
+
+	// State of the instances in global memory
+	__global float *distCentroids = distances + (groupId * N_INSTANCES);
+	__global uchar *mapping = mappings + (groupId * N_INSTANCES);
+
+	// The individual is cached into local memory to improve performance
+	__local int selFeatures[N_FEATURES];
+	__local float centroids_l[K * N_FEATURES];
+	__local float sums[K * N_FEATURES];
+	__local uchar tileMapping[TILE_INSTANCES];
+	__local int samples_in_k[K];
+	__local int changes;
+	__local int nSelFeatures;
+	bool converged;
+
+
+	// Each work-group compute an individual (master-slave as a deck algorithm)
+	for (int ind = begin + groupId; ind < end; ind += numGroups) {
+
+		// Dense list with the indexes of the selected features
+		if (localId == 0) {
+			__global uchar *packed = chromosomes + (ind * PACKED_CHROMOSOME);
+			int nSel = 0;
+			for (int f = 0; f < N_FEATURES; ++f) {
+				if ((packed[f >> 3] >> (f & 7)) & 1) {
+					selFeatures[nSel++] = f;
+				}
+			}
+			nSelFeatures = nSel;
+		}
+
+		// Initialize the mapping table
+		for (int i = localId; i < N_INSTANCES; i += localSize) {
+			mapping[i] = 0;
+		}
+
+		// Syncpoint
+		barrier(CLK_LOCAL_MEM_FENCE | CLK_GLOBAL_MEM_FENCE);
+		const int nSel = nSelFeatures;
+
+		// The centroids will have the selected features of the individual ('nSel' coordinates each one)
+		for (int kj = localId; kj < K * nSel; kj += localSize) {
+			int k = kj / nSel;
+			int j = kj - (k * nSel);
+			centroids_l[kj] = trDataBase[(selInstances[k] * N_FEATURES) + selFeatures[j]];
+		}
+
+		converged = false;
+
+
+		/******************** Convergence process *********************/
+
+		// K-means stops when it converges or after 'MAX_ITER_KMEANS' iterations
+		int maxIter;
+		for (maxIter = 0; maxIter < MAX_ITER_KMEANS && !converged; ++maxIter) {
+
+			barrier(CLK_LOCAL_MEM_FENCE);
+
+			for (int k = localId; k < K; k += localSize) {
+				samples_in_k[k] = 0;
+			}
+			if (localId == 0) {
+				changes = 0;
+			}
+
+			// Syncpoint
+			barrier(CLK_LOCAL_MEM_FENCE);
+
+			// Calculate all distances (Euclidean distance) between each instance and the centroids
+			for (int i = localId; i < N_INSTANCES; i += localSize) {
+				float minDist = INFINITY;
+				int selectCentroid = 0;
+				for (int k = 0; k < K; ++k) {
+					float dist = 0.0f;
+					for (int j = 0; j < nSel; ++j) {
+						float dif = transposedDataBase[(N_INSTANCES * selFeatures[j]) + i] - centroids_l[(k * nSel) + j];
+						dist = mad(dif, dif, dist);
+					}
+
+					if (dist < minDist) {
+						minDist = dist;
+						selectCentroid = k;
+					}
+				}
+
+				distCentroids[i] = minDist;
+				atomic_inc(&samples_in_k[selectCentroid]);
+
+				if (mapping[i] != selectCentroid) {
+					mapping[i] = selectCentroid;
+					atomic_inc(&changes);
+				}
+			}
+
+			// Syncpoint
+			barrier(CLK_LOCAL_MEM_FENCE | CLK_GLOBAL_MEM_FENCE);
+
+			// With a null tolerance, the centroids would not move anymore (fixed point). All work-items take the same decision
+			converged = (maxIter > 0 && changes <= MAX_CHANGES_KMEANS);
+
+			// Update the position of the centroids. Each work-item adds the same coordinates in all the tiles
+			if (!converged) {
+				for (int kj = localId; kj < K * nSel; kj += localSize) {
+					sums[kj] = 0.0f;
+				}
+				for (int tile = 0; tile < N_INSTANCES; tile += TILE_INSTANCES) {
+					int tileSize = min(TILE_INSTANCES, N_INSTANCES - tile);
+
+					// The mapping of the tile is cached into local memory
+					barrier(CLK_LOCAL_MEM_FENCE);
+					for (int t = localId; t < tileSize; t += localSize) {
+						tileMapping[t] = mapping[tile + t];
+					}
+					barrier(CLK_LOCAL_MEM_FENCE);
+
+					for (int kj = localId; kj < K * nSel; kj += localSize) {
+						int k = kj / nSel;
+						int j = kj - (k * nSel);
+						__global float *column = transposedDataBase + (N_INSTANCES * selFeatures[j]) + tile;
+						float sum = 0.0f;
+						for (int t = 0; t < tileSize; ++t) {
+							sum += (tileMapping[t] == k) ? column[t] : 0;
+						}
+						sums[kj] += sum;
+					}
+				}
+				for (int kj = localId; kj < K * nSel; kj += localSize) {
+					int k = kj / nSel;
+					if (samples_in_k[k] > 0) {
+						centroids_l[kj] = sums[kj] / samples_in_k[k];
+					}
+				}
+			}
+		}
+
+		// Syncpoint
+		barrier(CLK_LOCAL_MEM_FENCE | CLK_GLOBAL_MEM_FENCE);
+
+
+		/************ Minimize the within-cluster and maximize Inter-cluster sum of squares (WCSS and ICSS) *************/
+
+		// Within-cluster
+		float partial = 0.0f;
+		for (int i = localId; i < N_INSTANCES; i += localSize) {
+			partial += sqrt(distCentroids[i]);
+		}
+		float sumWithin = reduceSum(partial, scratch);
+
+		// Inter-cluster. Each work-item computes the distance of some pairs of centroids
+		partial = 0.0f;
+		for (int pair = localId; pair < K * K; pair += localSize) {
+			int k1 = pair / K;
+			int k2 = pair - (k1 * K);
+			if (k2 > k1) {
+				float sum = 0.0f;
+				for (int j = 0; j < nSel; ++j) {
+					float dif = centroids_l[(k1 * nSel) + j] - centroids_l[(k2 * nSel) + j];
+					sum += dif * dif;
+				}
+				partial += sqrt(sum);
+			}
+		}
+		float sumInter = reduceSum(partial, scratch);
+
+		if (localId == 0) {
+
+			// First objective function (Within-cluster sum of squares (WCSS))
+			results[(ind * RESULT_STRIDE)] = sumWithin;
+
+			// Second objective function (Inter-cluster sum of squares (ICSS))
+			results[(ind * RESULT_STRIDE) + 1] = sumInter;
+
+			// Number of executed iterations
+			results[(ind * RESULT_STRIDE) + N_OBJECTIVES] = maxIter;
 		}
 
 		// Syncpoint
@@ -18,12 +18,442 @@
 /********************************** Includes **********************************/
 
 #include "evaluation.h"
+#include "gemm.h"
+#include "rng.h"
+#include "simd.h"
 #include "zitzler.h"
 #include <omp.h> // OpenMP
 #include <math.h> // exp, sqrt, INFINITY
+#include <float.h> // FLT_EPSILON
+#include <map> // std::map
+#include <utility> // std::pair
+
+/********************************* Defines ********************************/
+
+#define INSTANCES_PER_TILE 64 // Multiple of 'SIMD_MAX_WIDTH'. The tile of the selected database must fit in the L1 cache
+#define INDIVIDUALS_PER_GEMM 16 // Maximum number of individuals whose distances are computed by the same matrix product
+#define MIN_INSTANCES_PER_THREAD 1024 // Minimum number of instances of each thread when the instances of an individual are split
+#define CHUNKS_IN_FLIGHT 2 // Maximum number of chunks enqueued at the same time in each OpenCL device
+#define CHUNK_FACTOR 2 // Each device takes this fraction of its share of the remaining individuals (factoring self-scheduling)
+#define MAX_INDIVIDUALS_ON_GPU_KERNEL 10000 // Maximum number of individuals evaluated by a kernel launch in a GPU
+#define THROUGHPUT_SMOOTHING 0.5 // Weight of the previous throughput of a device when a new measure is added
 
 /********************************* Methods ********************************/
 
+/**
+ * @brief Sets the initial centroids of K-means for an individual
+ *
+ * If the partition of its primary parent is known, each centroid is the mean of the instances of its cluster, that is, the centroid of the parent projected onto the selected features of the individual. Otherwise, the centroids are the instances chosen by 'getCentroids'
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selFeatures The indexes of the selected features of the individual
+ * @param nSelFeatures The number of selected features
+ * @param selInstances The instances choosen as initial centroids
+ * @param partition The cluster of each instance in the parent. NULL if it is unknown
+ * @param centroids The 'K' centroids will be stored
+ * @param ldCentroids The distance between two consecutive centroids
+ * @param sumCentroids Scratch buffer of 'K * nSelFeatures' elements
+ * @param samples_in_k Scratch buffer of 'K' elements
+ * @param conf The structure with all configuration parameters
+ */
+static void initialCentroids(const float *const trDataBase, const int *const selFeatures, const int nSelFeatures, const int *const selInstances, const unsigned char *const partition, float *const centroids, const int ldCentroids, float *const sumCentroids, int *const samples_in_k, const Config *const conf) {
+
+	for (int k = 0; k < conf -> K; ++k) {
+		const float *const row = trDataBase + (conf -> nFeatures * selInstances[k]);
+		for (int j = 0; j < nSelFeatures; ++j) {
+			centroids[(k * ldCentroids) + j] = row[selFeatures[j]];
+		}
+	}
+
+	if (partition != NULL) {
+		for (int k = 0; k < conf -> K; ++k) {
+			samples_in_k[k] = 0;
+		}
+		for (int kj = 0; kj < conf -> K * nSelFeatures; ++kj) {
+			sumCentroids[kj] = 0.0f;
+		}
+		for (int i = 0; i < conf -> trNInstances; ++i) {
+			const float *const row = trDataBase + (conf -> nFeatures * i);
+			float *const sum = sumCentroids + (partition[i] * nSelFeatures);
+			samples_in_k[partition[i]]++;
+			for (int j = 0; j < nSelFeatures; ++j) {
+				sum[j] += row[selFeatures[j]];
+			}
+		}
+
+		// The empty clusters keep the initial centroid
+		for (int k = 0; k < conf -> K; ++k) {
+			if (samples_in_k[k] > 0) {
+				for (int j = 0; j < nSelFeatures; ++j) {
+					centroids[(k * ldCentroids) + j] = sumCentroids[(k * nSelFeatures) + j] / samples_in_k[k];
+				}
+			}
+		}
+	}
+}
+
+
+/**
+ * @brief Computes the inter-cluster sum of distances (ICSS) of a clustering
+ * @param centroids The centroids. Each one contains 'nSelFeatures' coordinates
+ * @param nSelFeatures The number of selected features
+ * @param K The number of centroids
+ * @return The sum of the Euclidean distances between each pair of centroids
+ */
+static float interClusterSum(const float *const centroids, const int nSelFeatures, const int K) {
+
+	float sumInter = 0.0f;
+	for (int k = 0; k < K; ++k) {
+		const float *const centr = centroids + (k * nSelFeatures);
+		for (int kk = k + 1; kk < K; ++kk) {
+			const float *const centr2 = centroids + (kk * nSelFeatures);
+			float sum = 0.0f;
+			for (int j = 0; j < nSelFeatures; ++j) {
+				sum += (centr[j] - centr2[j]) * (centr[j] - centr2[j]);
+			}
+			sumInter += sqrt(sum);
+		}
+	}
+
+	return sumInter;
+}
+
+
+/**
+ * @brief Assigns the instances of a tile to their nearest centroid, skipping the instances whose centroid cannot change according to the Hamerly bounds
+ *
+ * The bounds are widened by the rounding error of the squared distances, so the mapping is exactly the same as the one of Lloyd's algorithm
+ * @param selDataBase The selected features of the database in feature-major order
+ * @param stride The length of each row of 'selDataBase'
+ * @param nSelFeatures The number of selected features (rows of 'selDataBase')
+ * @param centroids The centroids. Each one contains 'nSelFeatures' coordinates
+ * @param K The number of centroids
+ * @param begin The first instance to be assigned. It must be a multiple of 'SIMD_MAX_WIDTH'
+ * @param end The 'end-1' position is the last instance to be assigned. The tile can not contain more than 'INSTANCES_PER_TILE' instances
+ * @param useBounds If false, all the distances are computed and the bounds are reset
+ * @param halfDist Half of the distance between each centroid and its nearest centroid
+ * @param mapping The nearest centroid of each instance. It is only updated for the instances not skipped
+ * @param distCentroids The squared distance to the nearest centroid. It is only updated for the instances not skipped
+ * @param secondDist Scratch space for the squared distance to the second nearest centroid of each instance
+ * @param upper The upper bound of the distance between each instance and its centroid
+ * @param lower The lower bound of the distance between each instance and the rest of centroids
+ * @param pendingDataBase Aligned scratch space where the instances not skipped are packed in feature-major order (rows of 'INSTANCES_PER_TILE' elements)
+ */
+static void assignHamerly(const float *const selDataBase, const int stride, const int nSelFeatures, const float *const centroids, const int K, const int begin, const int end, const bool useBounds, const double *const halfDist, unsigned char *const mapping, float *const distCentroids, float *const secondDist, double *const upper, double *const lower, float *const pendingDataBase) {
+
+	// Maximum relative error of a squared distance computed in simple precision (with a safety factor of 2)
+	const double gamma = (nSelFeatures + 3) * (double) FLT_EPSILON;
+	const double slack = sqrt((1.0 + gamma) / (1.0 - gamma));
+
+	// Instances whose upper bound does not discard the rest of centroids
+	int pending[INSTANCES_PER_TILE];
+	int nPending = 0;
+	for (int i = begin; i < end && useBounds; ++i) {
+		if (upper[i] * slack >= std::max(halfDist[mapping[i]], lower[i])) {
+			pending[nPending++] = i;
+		}
+	}
+
+	// Packing an instance costs as much as computing 'SIMD_MAX_WIDTH' centroids, so the whole tile is computed if few instances are skipped
+	if (!useBounds || nPending * (SIMD_MAX_WIDTH + K) >= (end - begin) * K) {
+		assignInstances(selDataBase, stride, nSelFeatures, centroids, K, begin, end, mapping, distCentroids, secondDist);
+		for (int i = begin; i < end; ++i) {
+			upper[i] = sqrt(distCentroids[i] / (1.0 - gamma));
+			lower[i] = sqrt(secondDist[i] / (1.0 + gamma));
+		}
+		return;
+	}
+
+	// The pending instances are packed, so the vectorized kernel only computes them
+	if (nPending > 0) {
+		unsigned char pendingMapping[INSTANCES_PER_TILE];
+		float pendingDist[INSTANCES_PER_TILE];
+		float pendingSecond[INSTANCES_PER_TILE];
+		for (int j = 0; j < nSelFeatures; ++j) {
+			const float *const row = selDataBase + (stride * j);
+			float *const pendingRow = pendingDataBase + (INSTANCES_PER_TILE * j);
+			for (int p = 0; p < nPending; ++p) {
+				pendingRow[p] = row[pending[p]];
+			}
+		}
+		assignInstances(pendingDataBase, INSTANCES_PER_TILE, nSelFeatures, centroids, K, 0, nPending, pendingMapping, pendingDist, pendingSecond);
+		for (int p = 0; p < nPending; ++p) {
+			const int i = pending[p];
+			mapping[i] = pendingMapping[p];
+			distCentroids[i] = pendingDist[p];
+			upper[i] = sqrt(pendingDist[p] / (1.0 - gamma));
+			lower[i] = sqrt(pendingSecond[p] / (1.0 + gamma));
+		}
+	}
+}
+
+
+/**
+ * @brief Gets the size of the scratch arena needed by each thread of the CPU evaluation
+ *
+ * The buffers taken by 'evaluationCPU' and 'evaluationCPUGemm' are added in the same order as they are allocated
+ * @param conf The structure with all configuration parameters
+ * @return The size in bytes of the arena
+ */
+size_t evaluationScratchSize(const Config *const conf) {
+
+	const size_t N = conf -> trNInstances;
+	const size_t nFeatures = conf -> nFeatures;
+	const size_t K = conf -> K;
+
+	// Lloyd and Hamerly (the bounds are always counted)
+	const size_t stride = ((N + SIMD_MAX_WIDTH - 1) / SIMD_MAX_WIDTH) * SIMD_MAX_WIDTH;
+	const size_t strideK = ((K + SIMD_MAX_WIDTH - 1) / SIMD_MAX_WIDTH) * SIMD_MAX_WIDTH;
+	size_t single = ScratchArena::bytes<unsigned char>(N) + (2 * ScratchArena::bytes<float>(K * nFeatures)) + ScratchArena::bytes<float>(N)
+	              + ScratchArena::bytes<int>(K) + ScratchArena::bytes<int>(nFeatures)
+	              + (2 * ScratchArena::bytes<double>(N)) + (2 * ScratchArena::bytes<double>(K)) + ScratchArena::bytes<unsigned char>(K)
+	              + (2 * ScratchArena::bytes<float>(K)) + ScratchArena::bytes<float>(N)
+	              + ScratchArena::bytes<float>(stride * nFeatures) + ScratchArena::bytes<float>(INSTANCES_PER_TILE * nFeatures) + ScratchArena::bytes<float>(strideK * nFeatures);
+
+	// Blocks of individuals of the matrix product
+	const size_t B = INDIVIDUALS_PER_GEMM;
+	size_t batched = ScratchArena::bytes<unsigned char>(B * N) + ScratchArena::bytes<float>(B * K * nFeatures) + ScratchArena::bytes<float>(K * nFeatures)
+	               + ScratchArena::bytes<float>(B * K) + ScratchArena::bytes<int>(K) + ScratchArena::bytes<int>(B * nFeatures) + ScratchArena::bytes<int>(B)
+	               + ScratchArena::bytes<int>(B * nFeatures) + ScratchArena::bytes<int>(nFeatures) + (2 * ScratchArena::bytes<int>(B))
+	               + ScratchArena::bytes<bool>(B) + ScratchArena::bytes<float>(B)
+	               + ScratchArena::bytes<float>(N * nFeatures) + ScratchArena::bytes<float>(B * K * nFeatures) + ScratchArena::bytes<float>(N * B * K)
+	               + ScratchArena::bytes<float>(B * N) + ScratchArena::bytes<float>(sgemmWorkspaceSize());
+
+	return std::max(single, batched);
+}
+
+
+/**
+ * @brief Evaluation of blocks of individuals in CPU. The distances of all the individuals of a block are computed at the same time with a matrix product
+ *
+ * The squared distance is expanded as ||x||^2 - 2 * x * c + ||c||^2. The centroids of each individual are zero outside its selected features, so the cross terms of the whole block are given by one product between the instances and all the centroids of the block
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param nThreads The number of threads to perform the individuals evaluation
+ * @param arenas The scratch arenas of the threads
+ * @param partitionTable The table containing the K-means partitions of the evaluated chromosomes. NULL if the warm start is disabled
+ * @param conf The structure with all configuration parameters
+ */
+static void evaluationCPUGemm(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, ScratchArena *const arenas, PartitionTable *const partitionTable, const Config *const conf) {
+
+	// The blocks are reduced when there are not enough individuals for all the threads
+	const int blockSize = std::max(1, std::min(INDIVIDUALS_PER_GEMM, (nIndividuals + nThreads - 1) / nThreads));
+	const int nBlocks = (nIndividuals + blockSize - 1) / blockSize;
+
+	#pragma omp parallel num_threads(nThreads) if (nThreads > 1)
+	{
+		const int N = conf -> trNInstances;
+		const int nFeatures = conf -> nFeatures;
+		const int K = conf -> K;
+		const int maxChanges = (int) (conf -> kmeansTolerance * N);
+
+		// All the buffers are taken from the arena of the thread (see 'evaluationScratchSize')
+		ScratchArena *const arena = arenas + omp_get_thread_num();
+		arena -> reset();
+		unsigned char *const mapping = arena -> alloc<unsigned char>(blockSize * N);
+		float *const centroids = arena -> alloc<float>(blockSize * K * nFeatures);
+		float *const sumCentroids = arena -> alloc<float>(K * nFeatures);
+		float *const centroidsNorm = arena -> alloc<float>(blockSize * K);
+		int *const samples_in_k = arena -> alloc<int>(K);
+		int *const selFeatures = arena -> alloc<int>(blockSize * nFeatures);
+		int *const nSelFeatures = arena -> alloc<int>(blockSize);
+		int *const unionPos = arena -> alloc<int>(blockSize * nFeatures);
+		int *const unionFeatures = arena -> alloc<int>(nFeatures);
+		int *const active = arena -> alloc<int>(blockSize);
+		int *const activeList = arena -> alloc<int>(blockSize);
+		bool *const warm = arena -> alloc<bool>(blockSize);
+		float *const sumWithin = arena -> alloc<float>(blockSize);
+
+		// Matrices of the product: the selected columns of the block (instance-major), the centroids of the active individuals and the cross terms
+		float *const unionDataBase = arena -> alloc<float>(N * nFeatures);
+		float *const centroidsMatrix = arena -> alloc<float>(blockSize * K * nFeatures);
+		float *const crossTerms = arena -> alloc<float>(N * blockSize * K);
+		float *const instancesNorm = arena -> alloc<float>(blockSize * N);
+		float *const gemmWorkspace = arena -> alloc<float>(sgemmWorkspaceSize());
+
+		#pragma omp for schedule(dynamic)
+		for (int block = 0; block < nBlocks; ++block) {
+			Individual *const first = subpop + (block * blockSize);
+			const int nb = std::min(blockSize, nIndividuals - (block * blockSize));
+
+			// Union of the features selected by the individuals of the block
+			int nUnion = 0;
+			for (int w = 0; w < CHROMOSOME_WORDS; ++w) {
+				uint64_t selected = 0;
+				for (int b = 0; b < nb; ++b) {
+					selected |= first[b].chromosome[w];
+				}
+				for (; selected != 0; selected &= selected - 1) {
+					unionFeatures[nUnion++] = (w << 6) + __builtin_ctzll(selected);
+				}
+			}
+			for (int i = 0; i < N; ++i) {
+				const float *const row = trDataBase + (nFeatures * i);
+				for (int u = 0; u < nUnion; ++u) {
+					unionDataBase[(nUnion * i) + u] = row[unionFeatures[u]];
+				}
+			}
+
+			// Selected features of each individual, their position in the union and the squared norm of the instances
+			for (int b = 0; b < nb; ++b) {
+				int *const sel = selFeatures + (b * nFeatures);
+				int *const pos = unionPos + (b * nFeatures);
+				nSelFeatures[b] = 0;
+				for (int u = 0; u < nUnion; ++u) {
+					if (first[b].getGene(unionFeatures[u])) {
+						sel[nSelFeatures[b]] = unionFeatures[u];
+						pos[nSelFeatures[b]++] = u;
+					}
+				}
+				for (int i = 0; i < N; ++i) {
+					const float *const row = unionDataBase + (nUnion * i);
+					float norm = 0.0f;
+					for (int j = 0; j < nSelFeatures[b]; ++j) {
+						norm += row[pos[j]] * row[pos[j]];
+					}
+					instancesNorm[(b * N) + i] = norm;
+				}
+
+				// The centroids will have the selected features of the individual
+				// If the partition of the parent is known, it initializes the mapping table and the centroids
+				unsigned char *const map = mapping + (b * N);
+				warm[b] = (partitionTable != NULL && partitionTable -> lookup(first[b].parentKey, map));
+				initialCentroids(trDataBase, sel, nSelFeatures[b], selInstances, (warm[b]) ? map : NULL, centroids + (b * K * nFeatures), nFeatures, sumCentroids, samples_in_k, conf);
+				for (int i = 0; i < N && !warm[b]; ++i) {
+					map[i] = 0;
+				}
+				active[b] = true;
+			}
+
+
+			/******************** Convergence process *********************/
+
+			int nActive = nb;
+			for (int maxIter = 0; maxIter < conf -> maxIterKmeans && nActive > 0; ++maxIter) {
+
+				// Matrix with the centroids of the active individuals (zero outside their selected features)
+				int nAct = 0;
+				for (int b = 0; b < nb; ++b) {
+					if (active[b]) {
+						for (int k = 0; k < K; ++k) {
+							const float *const centr = centroids + (((b * K) + k) * nFeatures);
+							float *const rowMatrix = centroidsMatrix + (((nAct * K) + k) * nUnion);
+							float norm = 0.0f;
+							for (int u = 0; u < nUnion; ++u) {
+								rowMatrix[u] = 0.0f;
+							}
+							for (int j = 0; j < nSelFeatures[b]; ++j) {
+								rowMatrix[unionPos[(b * nFeatures) + j]] = centr[j];
+								norm += centr[j] * centr[j];
+							}
+							centroidsNorm[(nAct * K) + k] = norm;
+						}
+						activeList[nAct++] = b;
+					}
+				}
+
+				// Cross terms between all the instances and all the centroids of the block
+				const int ldc = nAct * K;
+				sgemmNT(N, ldc, nUnion, unionDataBase, nUnion, centroidsMatrix, nUnion, crossTerms, ldc, gemmWorkspace);
+
+				for (int a = 0; a < nAct; ++a) {
+					const int b = activeList[a];
+					const int nSel = nSelFeatures[b];
+					const int *const pos = unionPos + (b * nFeatures);
+					unsigned char *const map = mapping + (b * N);
+					float *const centr = centroids + (b * K * nFeatures);
+					int changes = 0;
+
+					for (int k = 0; k < K; ++k) {
+						samples_in_k[k] = 0;
+					}
+					for (int kj = 0; kj < K * nSel; ++kj) {
+						sumCentroids[kj] = 0.0f;
+					}
+
+					// Nearest centroid of each instance. The lowest centroid wins the ties
+					for (int i = 0; i < N; ++i) {
+						const float *const cross = crossTerms + (i * ldc) + (a * K);
+						const float norm = instancesNorm[(b * N) + i];
+						float minDist = INFINITY;
+						int selectCentroid = 0;
+						for (int k = 0; k < K; ++k) {
+							float dist = norm - (2.0f * cross[k]) + centroidsNorm[(a * K) + k];
+							if (dist < minDist) {
+								minDist = dist;
+								selectCentroid = k;
+							}
+						}
+						changes += (map[i] != selectCentroid);
+						map[i] = selectCentroid;
+						samples_in_k[selectCentroid]++;
+
+						// Accumulate the coordinates of the instance on its centroid
+						const float *const row = unionDataBase + (nUnion * i);
+						float *const sum = sumCentroids + (selectCentroid * nSel);
+						for (int j = 0; j < nSel; ++j) {
+							sum[j] += row[pos[j]];
+						}
+					}
+
+					// The expanded distances lose precision near the centroids, so the last ones are computed directly
+					const bool converged = ((maxIter > 0 || warm[b]) && changes <= maxChanges);
+					if (converged || maxIter == conf -> maxIterKmeans - 1) {
+						sumWithin[b] = 0.0f;
+						for (int i = 0; i < N; ++i) {
+							const float *const row = unionDataBase + (nUnion * i);
+							const float *const c = centr + (map[i] * nFeatures);
+							float dist = 0.0f;
+							for (int j = 0; j < nSel; ++j) {
+								float dif = row[pos[j]] - c[j];
+								dist += dif * dif;
+							}
+							sumWithin[b] += sqrt(dist);
+						}
+						first[b].nIterKmeans = maxIter + 1;
+						active[b] = false;
+						--nActive;
+					}
+
+					// Update the position of the centroids
+					for (int k = 0; k < K && !converged; ++k) {
+						if (samples_in_k[k] > 0) {
+							for (int j = 0; j < nSel; ++j) {
+								centr[(k * nFeatures) + j] = sumCentroids[(k * nSel) + j] / samples_in_k[k];
+							}
+						}
+					}
+				}
+			}
+
+
+			/************ Minimize the within-cluster and maximize Inter-cluster sum of squares (WCSS and ICSS) *************/
+
+			for (int b = 0; b < nb; ++b) {
+				const int nSel = nSelFeatures[b];
+				float *const packedCentroids = sumCentroids;
+
+				// The final partition will warm-start the children of the individual
+				if (partitionTable != NULL) {
+					partitionTable -> insert(hashChromosome(first[b].chromosome, nFeatures).h1, mapping + (b * N));
+				}
+				for (int k = 0; k < K; ++k) {
+					for (int j = 0; j < nSel; ++j) {
+						packedCentroids[(k * nSel) + j] = centroids[(((b * K) + k) * nFeatures) + j];
+					}
+				}
+
+				// First objective function (Within-cluster sum of squares (WCSS))
+				first[b].fitness[0] = sumWithin[b];
+
+				// Second objective function (Inter-cluster sum of squares (ICSS))
+				first[b].fitness[1] = interClusterSum(packedCentroids, nSel, K);
+			}
+		}
+	}
+}
+
 
 /**
  * @brief Evaluation of each individual in CPU in Sequential mode or using OpenMP
@@ -32,91 +462,250 @@
  * @param trDataBase The training database which will contain the instances and the features
  * @param selInstances The instances choosen as initial centroids
  * @param nThreads The number of threads to perform the individuals evaluation
+ * @param arenas The scratch arenas of the threads. There must be one for each thread
+ * @param partitionTable The table containing the K-means partitions of the evaluated chromosomes. NULL if the warm start is disabled
  * @param conf The structure with all configuration parameters
  */
-void evaluationCPU(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, const Config *const conf) {
+void evaluationCPU(Individual *const subpop, const int nIndividuals, const float *const trDataBase, const int *const selInstances, const int nThreads, ScratchArena *const arenas, PartitionTable *const partitionTable, const Config *const conf) {
+
+
+	// The batched evaluation has its own parallel region
+	if (conf -> kmeansAlgorithm == KMEANS_GEMM) {
+		evaluationCPUGemm(subpop, nIndividuals, trDataBase, selInstances, nThreads, arenas, partitionTable, conf);
+		return;
+	}
 
 
 	/************ K-means algorithm in C++ ***********/
 
-	#pragma omp parallel num_threads(nThreads) if (nThreads > 1)
+	// When there are fewer individuals than threads, each individual is evaluated by a team of threads which split its instances
+	// The teams are not larger than needed to give 'MIN_INSTANCES_PER_THREAD' instances to each thread
+	int teamSize = 1;
+	if (nIndividuals < nThreads) {
+		teamSize = std::max(1, std::min(nThreads / std::max(1, nIndividuals), conf -> trNInstances / MIN_INSTANCES_PER_THREAD));
+	}
+	const int nTeams = nThreads / teamSize;
+
+	#pragma omp parallel num_threads(nTeams) if (nTeams > 1)
 	{
-		const int totalCoord = conf -> K * conf -> nFeatures;
-		unsigned char mapping[conf -> trNInstances];
-		float centroids[totalCoord];
-		float distCentroids[conf -> trNInstances];
-		int samples_in_k[conf -> K];
+		// All the buffers are taken from the arena of the first thread of the team (see 'evaluationScratchSize')
+		ScratchArena *const arena = arenas + (omp_get_thread_num() * teamSize);
+		arena -> reset();
+		unsigned char *const mapping = arena -> alloc<unsigned char>(conf -> trNInstances);
+		float *const centroids = arena -> alloc<float>(conf -> K * conf -> nFeatures);
+		float *const sumCentroids = arena -> alloc<float>(conf -> K * conf -> nFeatures);
+		float *const distCentroids = arena -> alloc<float>(conf -> trNInstances);
+		int *const samples_in_k = arena -> alloc<int>(conf -> K);
+		int *const selFeatures = arena -> alloc<int>(conf -> nFeatures);
+		const int maxChanges = (int) (conf -> kmeansTolerance * conf -> trNInstances);
+
+		// Bounds of the Hamerly algorithm
+		const bool hamerly = (conf -> kmeansAlgorithm == KMEANS_HAMERLY);
+		const int nBounds = (hamerly) ? conf -> trNInstances : 1;
+		double *const upper = arena -> alloc<double>(nBounds);
+		double *const lower = arena -> alloc<double>(nBounds);
+		double *const halfDist = arena -> alloc<double>(conf -> K);
+		double *const drift = arena -> alloc<double>(conf -> K);
+		unsigned char *const centroidsMapping = arena -> alloc<unsigned char>(conf -> K);
+		float *const centroidsDist = arena -> alloc<float>(conf -> K);
+		float *const centroidsSecond = arena -> alloc<float>(conf -> K);
+		float *const secondDist = arena -> alloc<float>(nBounds);
+
+		// Contiguous and aligned copy of the selected columns of the database (feature-major order)
+		// Each row is padded to be processed with the widest vector extension
+		const int stride = ((conf -> trNInstances + SIMD_MAX_WIDTH - 1) / SIMD_MAX_WIDTH) * SIMD_MAX_WIDTH;
+		float *const selDataBase = arena -> alloc<float>(stride * conf -> nFeatures);
+		const int strideK = ((conf -> K + SIMD_MAX_WIDTH - 1) / SIMD_MAX_WIDTH) * SIMD_MAX_WIDTH;
+		float *const pendingDataBase = (hamerly) ? arena -> alloc<float>(INSTANCES_PER_TILE * conf -> nFeatures) : NULL;
+		float *const trCentroids = (hamerly) ? arena -> alloc<float>(strideK * conf -> nFeatures) : NULL;
 
 		// Evaluate all individuals
 		#pragma omp for
 		for (int ind = 0; ind < nIndividuals; ++ind) {
 
-			// The centroids will have the selected features of the individual
-			for (int k = 0; k < conf -> K; ++k) {
-				int posTrDataBase = selInstances[k] * conf -> nFeatures;
-				int posCentr = k * conf -> nFeatures;
-
-				for (int f = 0; f < conf -> nFeatures; ++f) {
-					centroids[posCentr + f] = trDataBase[posTrDataBase + f];
+			// Dense list with the indexes of the selected features
+			int nSelFeatures = 0;
+			for (int w = 0; w < CHROMOSOME_WORDS; ++w) {
+				for (uint64_t genes = subpop[ind].chromosome[w]; genes != 0; genes &= genes - 1) {
+					selFeatures[nSelFeatures++] = (w << 6) + __builtin_ctzll(genes);
 				}
 			}
 
-			// Initialize the mapping table
-			for (int i = 0; i < conf -> trNInstances; ++i) {
-				mapping[i] = 0;
-			}
-
+			// Variables shared by the threads of the team
+			bool warm = false;
+			int changes = 0;
+			int nIter = 0;
 
-			/******************** Convergence process *********************/
+			// The threads of the team split the tiles of instances. The results do not depend on the size of the team:...
+			// ...each instance is assigned independently and each centroid sum adds the instances in the same order
+			#pragma omp parallel num_threads(teamSize) if (teamSize > 1)
+			{
+				const int member = omp_get_thread_num();
+				unsigned char prevMapping[INSTANCES_PER_TILE];
+
+				// The other threads of the team pack their pending instances in their own arenas
+				float *pending = pendingDataBase;
+				if (hamerly && member > 0) {
+					arena[member].reset();
+					pending = arena[member].alloc<float>(INSTANCES_PER_TILE * conf -> nFeatures);
+				}
 
-			// To avoid poor performance, 'conf -> maxIterKmeans' iterations are executed
-			for (int maxIter = 0; maxIter < conf -> maxIterKmeans; ++maxIter) {
+				// The selected columns are gathered once. Then, K-means only works over them without branches
+				#pragma omp for
+				for (int i = 0; i < conf -> trNInstances; ++i) {
+					const float *const row = trDataBase + (conf -> nFeatures * i);
+					for (int j = 0; j < nSelFeatures; ++j) {
+						selDataBase[(stride * j) + i] = row[selFeatures[j]];
+					}
+				}
 
-				for (int k = 0; k < conf -> K; ++k) {
-					samples_in_k[k] = 0;
+				// The centroids will have the selected features of the individual
+				// If the partition of the parent is known, it initializes the mapping table and the centroids
+				#pragma omp single
+				{
+					warm = (partitionTable != NULL && partitionTable -> lookup(subpop[ind].parentKey, mapping));
+					initialCentroids(trDataBase, selFeatures, nSelFeatures, selInstances, (warm) ? mapping : NULL, centroids, nSelFeatures, sumCentroids, samples_in_k, conf);
+					for (int i = 0; i < conf -> trNInstances && !warm; ++i) {
+						mapping[i] = 0;
+					}
 				}
 
-				// Calculate all distances (Euclidean distance) between each instance and the centroids
-				for (int i = 0; i < conf -> trNInstances; ++i) {
-					float minDist = INFINITY;
-					int selectCentroid;
-					int pos = conf -> nFeatures * i;
-					for (int k = 0, posCentr = 0; k < conf -> K; ++k, posCentr += conf -> nFeatures) {
-						float dist = 0.0f;
-						for (int f = 0; f < conf -> nFeatures; ++f) {
-							if (subpop[ind].chromosome[f]) {
-								float dif = trDataBase[pos + f] - centroids[posCentr + f];
-								dist += dif * dif;
+
+				/******************** Convergence process *********************/
+
+				// K-means stops when it converges or after 'conf -> maxIterKmeans' iterations
+				// Each thread keeps its own copy of the decision, which is taken from the same shared counters
+				bool done = false;
+				int maxIter;
+				for (maxIter = 0; maxIter < conf -> maxIterKmeans && !done; ++maxIter) {
+
+					// The bounds are not used in the first iteration nor in the last one (all the distances must be exact)
+					const bool useBounds = (hamerly && maxIter > 0 && maxIter < conf -> maxIterKmeans - 1);
+
+					#pragma omp single
+					{
+						changes = 0;
+						for (int k = 0; k < conf -> K; ++k) {
+							samples_in_k[k] = 0;
+						}
+						for (int kj = 0; kj < conf -> K * nSelFeatures; ++kj) {
+							sumCentroids[kj] = 0.0f;
+						}
+
+						// The centroids are assigned to themselves, so the second nearest one gives the distance to the nearest centroid
+						if (useBounds) {
+							for (int j = 0; j < nSelFeatures; ++j) {
+								for (int k = 0; k < conf -> K; ++k) {
+									trCentroids[(strideK * j) + k] = centroids[(k * nSelFeatures) + j];
+								}
+							}
+							assignInstances(trCentroids, strideK, nSelFeatures, centroids, conf -> K, 0, conf -> K, centroidsMapping, centroidsDist, centroidsSecond);
+							const double gamma = (nSelFeatures + 3) * (double) FLT_EPSILON;
+							for (int k = 0; k < conf -> K; ++k) {
+								halfDist[k] = 0.5 * sqrt(centroidsSecond[k] / (1.0 + gamma));
 							}
 						}
+					}
 
-						if (dist < minDist) {
-							minDist = dist;
-							selectCentroid = k;
+					// The instances are processed by tiles. Without team, the assignment and the accumulation of the centroid sums are fused...
+					// ...so each instance is read from memory once per iteration (the second access hits the cache)
+					#pragma omp for reduction(+:changes) reduction(+:samples_in_k[:conf -> K])
+					for (int tile = 0; tile < conf -> trNInstances; tile += INSTANCES_PER_TILE) {
+						const int tileEnd = std::min(tile + INSTANCES_PER_TILE, conf -> trNInstances);
+						for (int i = tile; i < tileEnd; ++i) {
+							prevMapping[i - tile] = mapping[i];
+						}
+
+						// Calculate all distances (Euclidean distance) between each instance and the centroids
+						if (hamerly) {
+							assignHamerly(selDataBase, stride, nSelFeatures, centroids, conf -> K, tile, tileEnd, useBounds, halfDist, mapping, distCentroids, secondDist, upper, lower, pending);
+						}
+						else {
+							assignInstances(selDataBase, stride, nSelFeatures, centroids, conf -> K, tile, tileEnd, mapping, distCentroids, NULL);
+						}
+
+						// Accumulate the coordinates of the instances on their nearest centroid
+						for (int i = tile; i < tileEnd; ++i) {
+							samples_in_k[mapping[i]]++;
+							changes += (mapping[i] != prevMapping[i - tile]);
+						}
+						for (int j = 0; j < nSelFeatures && teamSize == 1; ++j) {
+							const float *const column = selDataBase + (stride * j);
+							for (int i = tile; i < tileEnd; ++i) {
+								sumCentroids[(mapping[i] * nSelFeatures) + j] += column[i];
+							}
 						}
 					}
 
-					distCentroids[i] = minDist;
-					samples_in_k[selectCentroid]++;
-					if (mapping[i] != selectCentroid) {
-						mapping[i] = selectCentroid;
+					// The team splits the features of the centroid sums, so each sum is computed by only one thread
+					if (teamSize > 1) {
+						#pragma omp for
+						for (int j = 0; j < nSelFeatures; ++j) {
+							const float *const column = selDataBase + (stride * j);
+							for (int i = 0; i < conf -> trNInstances; ++i) {
+								sumCentroids[(mapping[i] * nSelFeatures) + j] += column[i];
+							}
+						}
 					}
-				}
 
-				// Update the position of the centroids
-				for (int f = 0; f < conf -> nFeatures; ++f) {
-					if (subpop[ind].chromosome[f]) {
+					// With a null tolerance, the centroids would not move anymore (fixed point)
+					// A warm start can converge in the first iteration, because the centroids are the means of the initial mapping
+					done = ((maxIter > 0 || warm) && changes <= maxChanges);
+
+					// Update the position of the centroids
+					if (!done) {
+						#pragma omp for
 						for (int k = 0; k < conf -> K; ++k) {
-							float sum = 0.0f;
-							for (int i = 0; i < conf -> trNInstances; ++i) {
-								if (mapping[i] == k) {
-									sum += trDataBase[(conf -> nFeatures * i) + f];
+							drift[k] = 0.0;
+							if (samples_in_k[k] > 0) {
+								for (int kj = k * nSelFeatures; kj < (k + 1) * nSelFeatures; ++kj) {
+									float newCentroid = sumCentroids[kj] / samples_in_k[k];
+									double dif = (double) newCentroid - centroids[kj];
+									drift[k] += dif * dif;
+									centroids[kj] = newCentroid;
 								}
 							}
-							centroids[(k * conf -> nFeatures) + f] = (samples_in_k[k] > 0) ? sum / samples_in_k[k] : centroids[(k * conf -> nFeatures) + f];
+							drift[k] = sqrt(drift[k]);
+						}
+					}
+
+					// The bounds are moved by the drift of the centroids
+					if (hamerly && !done) {
+						int maxDriftK = 0;
+						double secondDrift = 0.0;
+						for (int k = 1; k < conf -> K; ++k) {
+							if (drift[k] > drift[maxDriftK]) {
+								secondDrift = drift[maxDriftK];
+								maxDriftK = k;
+							}
+							else {
+								secondDrift = std::max(secondDrift, drift[k]);
+							}
+						}
+						#pragma omp for
+						for (int i = 0; i < conf -> trNInstances; ++i) {
+							upper[i] += drift[mapping[i]];
+							lower[i] -= (mapping[i] == maxDriftK) ? secondDrift : drift[maxDriftK];
 						}
 					}
 				}
+
+				// The distances of the instances skipped by Hamerly in the last iteration are not exact
+				if (hamerly && done) {
+					#pragma omp for
+					for (int tile = 0; tile < conf -> trNInstances; tile += INSTANCES_PER_TILE) {
+						assignInstances(selDataBase, stride, nSelFeatures, centroids, conf -> K, tile, std::min(tile + INSTANCES_PER_TILE, conf -> trNInstances), mapping, distCentroids, NULL);
+					}
+				}
+				if (member == 0) {
+					nIter = maxIter;
+				}
+			}
+			subpop[ind].nIterKmeans = nIter;
+
+			// The final partition will warm-start the children of the individual
+			if (partitionTable != NULL) {
+				partitionTable -> insert(hashChromosome(subpop[ind].chromosome, conf -> nFeatures).h1, mapping);
 			}
 
 
@@ -131,17 +720,7 @@ void evaluationCPU(Individual *const subpop, const int nIndividuals, const float
 			}
 
 			// Inter-cluster
-			for (int posCentr = 0; posCentr < totalCoord; posCentr += conf -> nFeatures) {
-				for (int i = posCentr + conf -> nFeatures; i < totalCoord; i += conf -> nFeatures) {
-					float sum = 0.0f;
-					for (int f = 0; f < conf -> nFeatures; ++f) {
-						if (subpop[ind].chromosome[f]) {
-							sum += (centroids[posCentr + f] - centroids[i + f]) * (centroids[posCentr + f] - centroids[i + f]);
-						}
-					}
-					sumInter += sqrt(sum);
-				}
-			}
+			sumInter = interClusterSum(centroids, nSelFeatures, conf -> K);
 
 			// First objective function (Within-cluster sum of squares (WCSS))
 			subpop[ind].fitness[0] = sumWithin;
@@ -154,47 +733,225 @@ void evaluationCPU(Individual *const subpop, const int nIndividuals, const float
 
 
 /**
- * @brief Evaluation of each individual on OpenCL devices
+ * @brief Gets the size of a bit-packed chromosome, as it is sent to the OpenCL devices
+ * @param conf The structure with all configuration parameters
+ * @return The number of bytes of the chromosome
+ */
+int packedChromosomeSize(const Config *const conf) {
+
+	return (conf -> nFeatures + 7) / 8;
+}
+
+
+/**
+ * @brief Copies the bit-packed chromosomes of the individuals in bytes (8 genes per byte, the first gene in the lowest bit)
+ * @param subpop The first individual of the current subpopulation
+ * @param nIndividuals The number of individuals whose chromosomes will be packed
+ * @param packed The packed chromosomes will be stored ('packedChromosomeSize' bytes each one)
+ * @param conf The structure with all configuration parameters
+ */
+static void packChromosomes(const Individual *const subpop, const int nIndividuals, unsigned char *const packed, const Config *const conf) {
+
+	const int packedSize = packedChromosomeSize(conf);
+	for (int ind = 0; ind < nIndividuals; ++ind) {
+		unsigned char *const bytes = packed + (ind * packedSize);
+		for (int b = 0; b < packedSize; ++b) {
+			bytes[b] = (unsigned char) (subpop[ind].chromosome[b >> 3] >> ((b & 7) << 3));
+		}
+	}
+}
+
+
+/**
+ * @brief Copies the results computed by an OpenCL device to the individuals
+ * @param results The fitness and the number of K-means iterations of each individual ('nObjectives + 1' elements each one)
+ * @param subpop The first individual of the current subpopulation
+ * @param begin The first individual whose results will be copied
+ * @param end The 'end-1' position is the last individual whose results will be copied
+ * @param conf The structure with all configuration parameters
+ */
+static void unpackResults(const float *const results, Individual *const subpop, const int begin, const int end, const Config *const conf) {
+
+	const int resultStride = conf -> nObjectives + 1;
+	for (int ind = begin; ind < end; ++ind) {
+		const float *const result = results + (ind * resultStride);
+		for (int obj = 0; obj < conf -> nObjectives; ++obj) {
+			subpop[ind].fitness[obj] = result[obj];
+		}
+		subpop[ind].nIterKmeans = (int) result[conf -> nObjectives];
+	}
+}
+
+
+/**
+ * @brief Adds the convergence statistics of a chunk of evaluated individuals to its device
+ * @param device The device which has evaluated the chunk
+ * @param subpop The first individual of the current subpopulation
+ * @param begin The first individual of the chunk
+ * @param end The 'end-1' position is the last individual of the chunk
+ */
+static void deviceStatistics(CLDevice *const device, const Individual *const subpop, const int begin, const int end) {
+
+	device -> nEvaluated += end - begin;
+	for (int i = begin; i < end; ++i) {
+		device -> nIterKmeans += subpop[i].nIterKmeans;
+	}
+}
+
+
+/**
+ * @brief Gets the number of individuals of the next chunk of a device. The chunks are proportional to the throughput of the devices and decrease as the evaluation progresses, so all the devices finish at the same time
+ * @param devicesObject Structure containing the OpenCL variables of a device
+ * @param nDevices The number of devices that will execute the evaluation
+ * @param dev The device which will evaluate the chunk
+ * @param remaining The number of individuals not assigned yet
+ * @return The number of individuals of the chunk
+ */
+static int chunkSize(const CLDevice *const devicesObject, const int nDevices, const int dev, const int remaining) {
+
+	const CLDevice *const device = devicesObject + dev;
+
+	// The CPU evaluates all the individuals at once when it is the only device
+	if (nDevices == 1 && device -> openMP) {
+		return remaining;
+	}
+
+	// The devices which have not been measured yet are considered as fast as the average of the others
+	double known = 0.0;
+	int nKnown = 0;
+	for (int d = 0; d < nDevices; ++d) {
+		double throughput;
+		#pragma omp atomic read
+		throughput = devicesObject[d].throughput;
+		if (throughput > 0.0) {
+			known += throughput;
+			++nKnown;
+		}
+	}
+	double average = (nKnown > 0) ? known / nKnown : 1.0;
+	double own;
+	#pragma omp atomic read
+	own = device -> throughput;
+	own = (own > 0.0) ? own : average;
+	double share = own / (known + ((nDevices - nKnown) * average));
+
+	// Each work-group (or slice of the packed kernel) receives at least one individual
+	int minChunk = std::max(1, device -> computeUnits * device -> packing);
+	int chunk = (int) ceil((remaining * share) / CHUNK_FACTOR);
+	chunk = ((chunk + minChunk - 1) / minChunk) * minChunk;
+	if (device -> deviceType == CL_DEVICE_TYPE_GPU && !(device -> openMP)) {
+		chunk = std::min(chunk, MAX_INDIVIDUALS_ON_GPU_KERNEL);
+	}
+
+	return std::max(chunk, minChunk);
+}
+
+
+/**
+ * @brief Adds a new measure to the throughput of a device. The throughput is kept between generations
+ * @param device The device which has evaluated the chunk
+ * @param nEvaluated The number of individuals of the chunk
+ * @param seconds The time spent evaluating the chunk
+ */
+static void updateThroughput(CLDevice *const device, const int nEvaluated, const double seconds) {
+
+	if (seconds > 0.0) {
+		double measure = nEvaluated / seconds;
+		double throughput;
+		#pragma omp atomic read
+		throughput = device -> throughput;
+		throughput = (throughput > 0.0) ? (THROUGHPUT_SMOOTHING * throughput) + ((1.0 - THROUGHPUT_SMOOTHING) * measure) : measure;
+		#pragma omp atomic write
+		device -> throughput = throughput;
+	}
+}
+
+
+/**
+ * @brief Evaluation of each individual on OpenCL devices. The raw fitness (not normalized) is obtained
  * @param subpop The first individual to evaluate of the current subpopulation
  * @param nIndividuals The number of individuals which will be evaluated
  * @param devicesObject Structure containing the OpenCL variables of a device
  * @param nDevices The number of devices that will execute the evaluation
  * @param trDataBase The training database which will contain the instances and the features
  * @param selInstances The instances choosen as initial centroids
+ * @param partitionTable The table containing the K-means partitions of the evaluated chromosomes. NULL if the warm start is disabled
+ * @param profiler The profiler which records the commands executed by the devices. NULL if the profiling is disabled
+ * @param island The island (subpopulation) whose individuals are evaluated
+ * @param generation The generation of the island
  * @param conf The structure with all configuration parameters
  */
-void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, const Config *const conf) {
+static void evaluationDevices(Individual *const subpop, const int nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, PartitionTable *const partitionTable, Profiler *const profiler, const int island, const int generation, const Config *const conf) {
 
 
 	/************ K-means algorithm in OpenCL ***********/
 
 	int index = 0;
 
+	// The OpenCL devices only receive the bit-packed chromosomes and only send the fitness back
+	bool openCL = false;
+	for (int dev = 0; dev < nDevices; ++dev) {
+		openCL |= !devicesObject[dev].openMP;
+	}
+	const int packedSize = packedChromosomeSize(conf);
+	const int resultStride = conf -> nObjectives + 1;
+	unsigned char *packed = NULL;
+	float *results = NULL;
+	if (openCL) {
+		packed = new unsigned char[nIndividuals * packedSize];
+		results = new float[nIndividuals * resultStride];
+		packChromosomes(subpop, nIndividuals, packed, conf);
+	}
+
 	#pragma omp parallel num_threads(nDevices)
 	{
-		int begin, end, maxProcessing;
+		int begin, end, maxProcessing, remaining;
 		bool finished = false;
 		int threadID = omp_get_thread_num();
 		cl_int status;
-		cl_event kernelEvent, copyEvent;
 
-		// Start the copy onto the devices
-		if (devicesObject[threadID].deviceType != CL_DEVICE_TYPE_CPU) {
-			check(clEnqueueWriteBuffer(devicesObject[threadID].commandQueue, devicesObject[threadID].objSubpopulations, CL_FALSE, 0, nIndividuals * sizeof(Individual), subpop, 0, NULL, &copyEvent) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_INDIVIDUALS);
-		}
+		// Chunks enqueued in the OpenCL device whose results have not been received yet (circular buffer)
+		int flightBegin[CHUNKS_IN_FLIGHT];
+		int flightEnd[CHUNKS_IN_FLIGHT];
+		cl_event flightWrite[CHUNKS_IN_FLIGHT];
+		cl_event flightKernel[CHUNKS_IN_FLIGHT];
+		cl_event flightRead[CHUNKS_IN_FLIGHT];
+		int oldest = 0;
+		int nInFlight = 0;
 
-		// Only 1 device (CPU or GPU)
-		if (nDevices == 1) {
-			int maxIndividualsOnGpuKernel = 10000;
-			maxProcessing = (devicesObject[threadID].deviceType == CL_DEVICE_TYPE_GPU) ? std::min(nIndividuals, maxIndividualsOnGpuKernel) : nIndividuals;
-		}
+		do {
 
-		// Heterogeneous mode
-		else {
-			maxProcessing = devicesObject[threadID].computeUnits;
-		}
+			// The oldest chunk is received when the pipeline is full or when there are no more chunks
+			if (nInFlight == CHUNKS_IN_FLIGHT || (finished && nInFlight > 0)) {
+				check(clWaitForEvents(1, &flightRead[oldest]) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_READING);
+
+				// The throughput of the device is measured with the profiling information of the kernel
+				cl_ulong kernelStart, kernelEnd;
+				check(clGetEventProfilingInfo(flightKernel[oldest], CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &kernelStart, NULL) != CL_SUCCESS, "%s\n", EV_ERROR_PROFILING);
+				check(clGetEventProfilingInfo(flightKernel[oldest], CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &kernelEnd, NULL) != CL_SUCCESS, "%s\n", EV_ERROR_PROFILING);
+				updateThroughput(&devicesObject[threadID], flightEnd[oldest] - flightBegin[oldest], (kernelEnd - kernelStart) * 1e-9);
+				if (profiler != NULL) {
+					int nChunk = flightEnd[oldest] - flightBegin[oldest];
+					profiler -> record(&devicesObject[threadID], island, generation, PROF_WRITE, nChunk, flightWrite[oldest]);
+					profiler -> record(&devicesObject[threadID], island, generation, PROF_KERNEL, nChunk, flightKernel[oldest]);
+					profiler -> record(&devicesObject[threadID], island, generation, PROF_READ, nChunk, flightRead[oldest]);
+				}
+				clReleaseEvent(flightWrite[oldest]);
+				clReleaseEvent(flightKernel[oldest]);
+				clReleaseEvent(flightRead[oldest]);
+				unpackResults(results, subpop, flightBegin[oldest], flightEnd[oldest], conf);
+				deviceStatistics(&devicesObject[threadID], subpop, flightBegin[oldest], flightEnd[oldest]);
+				oldest = (oldest + 1) % CHUNKS_IN_FLIGHT;
+				--nInFlight;
+				continue;
+			}
+
+			// Guided self-scheduling: the size of the chunk depends on the remaining individuals and on the throughput of the devices
+			#pragma omp atomic read
+			remaining = index;
+			remaining = nIndividuals - remaining;
+			maxProcessing = chunkSize(devicesObject, nDevices, threadID, std::max(remaining, 0));
 
-		do {
 			#pragma omp atomic capture
 			{
 				begin = index;
@@ -204,26 +961,133 @@ void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *cons
 			if (begin < nIndividuals) {
 				end = (begin + maxProcessing >= nIndividuals) ? nIndividuals : begin + maxProcessing;
 
-				if (devicesObject[threadID].deviceType != CL_DEVICE_TYPE_CPU) {
+				// The upload of the next chunk and the readback of the previous one overlap with the kernel of this chunk
+				if (!devicesObject[threadID].openMP) {
+					cl_event copyEvent, kernelEvent;
+					int slot = (oldest + nInFlight) % CHUNKS_IN_FLIGHT;
 
-					// Sets new kernel arguments
+					// Only the chromosomes of the chunk are copied onto the device
+					check(clEnqueueWriteBuffer(devicesObject[threadID].commandQueue, devicesObject[threadID].objChromosomes, CL_FALSE, begin * packedSize, (end - begin) * packedSize, packed + (begin * packedSize), 0, NULL, &copyEvent) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_INDIVIDUALS);
+
+					// Sets new kernel arguments. Their values are captured when the kernel is enqueued
 					check(clSetKernelArg(devicesObject[threadID].kernel, 3, sizeof(int), &begin) != CL_SUCCESS, "%s\n", EV_ERROR_KERNEL_ARGUMENT4);
 					check(clSetKernelArg(devicesObject[threadID].kernel, 4, sizeof(int), &end) != CL_SUCCESS, "%s\n", EV_ERROR_KERNEL_ARGUMENT5);
 
-					// Enqueue and execute the kernel
-					check((status = clEnqueueNDRangeKernel(devicesObject[threadID].commandQueue, devicesObject[threadID].kernel, 1, NULL, &(devicesObject[threadID].wiGlobal), &(devicesObject[threadID].wiLocal), 1, &copyEvent, &kernelEvent)) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_KERNEL);
+					// The tiled kernels of the device share its scratch buffers, so each one also waits for the kernel of the previous chunk
+					cl_event waitList[2] = {copyEvent, NULL};
+					cl_uint nWait = 1;
+					if (devicesObject[threadID].kernelVariant == KERNEL_TILED && nInFlight > 0) {
+						waitList[nWait++] = flightKernel[(slot + CHUNKS_IN_FLIGHT - 1) % CHUNKS_IN_FLIGHT];
+					}
 
-					// Read the data from the devices
-					check((status = clEnqueueReadBuffer(devicesObject[threadID].commandQueue, devicesObject[threadID].objSubpopulations, CL_TRUE, begin * sizeof(Individual), (end - begin) * sizeof(Individual), subpop + begin, 1, &kernelEvent, NULL)) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_READING);
+					// Enqueue and execute the kernel
+					check((status = clEnqueueNDRangeKernel(devicesObject[threadID].commandQueue, devicesObject[threadID].kernel, 1, NULL, &(devicesObject[threadID].wiGlobal), &(devicesObject[threadID].wiLocal), nWait, waitList, &kernelEvent)) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_KERNEL);
+
+					// Read the data from the devices without blocking
+					check((status = clEnqueueReadBuffer(devicesObject[threadID].commandQueue, devicesObject[threadID].objResults, CL_FALSE, begin * resultStride * sizeof(float), (end - begin) * resultStride * sizeof(float), results + (begin * resultStride), 1, &kernelEvent, &flightRead[slot])) != CL_SUCCESS, "%s\n", EV_ERROR_ENQUEUE_READING);
+					clFlush(devicesObject[threadID].commandQueue);
+					flightWrite[slot] = copyEvent;
+					flightKernel[slot] = kernelEvent;
+					flightBegin[slot] = begin;
+					flightEnd[slot] = end;
+					++nInFlight;
 				}
 				else {
-					evaluationCPU(subpop + begin, end - begin, trDataBase, selInstances, devicesObject[threadID].computeUnits, conf);
+					double start = omp_get_wtime();
+					evaluationCPU(subpop + begin, end - begin, trDataBase, selInstances, devicesObject[threadID].computeUnits, devicesObject[threadID].scratch, partitionTable, conf);
+					double finish = omp_get_wtime();
+					updateThroughput(&devicesObject[threadID], end - begin, finish - start);
+
+					// The CPU has not transfers. Its timestamps are taken from the wall clock
+					if (profiler != NULL) {
+						unsigned long long startNs = (unsigned long long) (start * 1e9);
+						profiler -> record(&devicesObject[threadID], island, generation, PROF_KERNEL, end - begin, startNs, startNs, startNs, (unsigned long long) (finish * 1e9));
+					}
+					deviceStatistics(&devicesObject[threadID], subpop, begin, end);
 				}
 			}
 			else {
 				finished = true;
 			}
-		} while (!finished);
+		} while (!finished || nInFlight > 0);
+	}
+
+	// Resources used are released
+	delete[] packed;
+	delete[] results;
+}
+
+
+/**
+ * @brief Evaluation of each individual on OpenCL devices
+ * @param subpop The first individual to evaluate of the current subpopulation
+ * @param nIndividuals The number of individuals which will be evaluated
+ * @param devicesObject Structure containing the OpenCL variables of a device
+ * @param nDevices The number of devices that will execute the evaluation
+ * @param trDataBase The training database which will contain the instances and the features
+ * @param selInstances The instances choosen as initial centroids
+ * @param fitnessCache The cache containing the raw fitness of the chromosomes already evaluated. NULL if it is disabled
+ * @param partitionTable The table containing the K-means partitions of the evaluated chromosomes. NULL if the warm start is disabled
+ * @param profiler The profiler which records the commands executed by the devices. NULL if the profiling is disabled
+ * @param island The island (subpopulation) whose individuals are evaluated
+ * @param generation The generation of the island
+ * @param conf The structure with all configuration parameters
+ */
+void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *const devicesObject, const int nDevices, const float *const trDataBase, const int *const selInstances, FitnessCache *const fitnessCache, PartitionTable *const partitionTable, Profiler *const profiler, const int island, const int generation, const Config *const conf) {
+
+	if (fitnessCache == NULL) {
+		evaluationDevices(subpop, nIndividuals, devicesObject, nDevices, trDataBase, selInstances, partitionTable, profiler, island, generation, conf);
+	}
+	else {
+
+
+		/************ Look for the chromosomes in the fitness cache ***********/
+
+		// Only the missing individuals are evaluated. Repeated chromosomes in the same batch are evaluated once
+		// The batch is indexed by the whole hash, so two chromosomes only sharing its first half are both evaluated
+		Individual *toEvaluate = new Individual[nIndividuals];
+		FitnessKey *keys = new FitnessKey[nIndividuals];
+		int *evaluatedAs = new int[nIndividuals];
+		std::map<std::pair<uint64_t, uint64_t>, int> batch;
+		int nToEvaluate = 0;
+		for (int i = 0; i < nIndividuals; ++i) {
+			keys[i] = hashChromosome(subpop[i].chromosome, conf -> nFeatures);
+			evaluatedAs[i] = -1;
+			subpop[i].nIterKmeans = 0;
+			if (!fitnessCache -> lookup(keys[i], subpop[i].fitness)) {
+				auto repeated = batch.find(std::make_pair(keys[i].h1, keys[i].h2));
+				if (repeated != batch.end()) {
+					evaluatedAs[i] = evaluatedAs[repeated -> second];
+				}
+				else {
+					batch[std::make_pair(keys[i].h1, keys[i].h2)] = i;
+					toEvaluate[nToEvaluate] = subpop[i];
+					evaluatedAs[i] = nToEvaluate++;
+				}
+			}
+		}
+
+		// Cache hits skip the devices entirely
+		if (nToEvaluate > 0) {
+			evaluationDevices(toEvaluate, nToEvaluate, devicesObject, nDevices, trDataBase, selInstances, partitionTable, profiler, island, generation, conf);
+		}
+
+		// The raw fitness is stored in the cache and copied to the individuals
+		for (int i = 0; i < nIndividuals; ++i) {
+			if (evaluatedAs[i] != -1) {
+				subpop[i].fitness[0] = toEvaluate[evaluatedAs[i]].fitness[0];
+				subpop[i].fitness[1] = toEvaluate[evaluatedAs[i]].fitness[1];
+				subpop[i].nIterKmeans = toEvaluate[evaluatedAs[i]].nIterKmeans;
+				if (batch[std::make_pair(keys[i].h1, keys[i].h2)] == i) {
+					fitnessCache -> insert(keys[i], subpop[i].fitness);
+				}
+			}
+		}
+
+		// Resources used are released
+		delete[] toEvaluate;
+		delete[] keys;
+		delete[] evaluatedAs;
 	}
 
 	// Fitness normalization
@@ -231,6 +1095,20 @@ void evaluation(Individual *const subpop, const int nIndividuals, CLDevice *cons
 }
 
 
+/**
+ * @brief Prints the number of individuals evaluated by each device and the average number of K-means iterations per individual
+ * @param devicesObject Structure containing the OpenCL variables of a device
+ * @param conf The structure with all configuration parameters
+ */
+void printEvaluationStats(const CLDevice *const devicesObject, const Config *const conf) {
+
+	for (int dev = 0; dev < conf -> nDevices; ++dev) {
+		double avgIter = (devicesObject[dev].nEvaluated > 0) ? (double) devicesObject[dev].nIterKmeans / devicesObject[dev].nEvaluated : 0.0;
+		fprintf(stderr, "Process %d: %s: %lld individuals evaluated, %.2f K-means iterations per individual (maximum %d)\n", conf -> mpiRank, devicesObject[dev].deviceName.c_str(), devicesObject[dev].nEvaluated, avgIter, conf -> maxIterKmeans);
+	}
+}
+
+
 /**
  * @brief Normalize the fitness for each individual
  * @param subpop The first individual to normalize of the current subpopulation
@@ -319,13 +1197,14 @@ int* getCentroids(const Config *const conf) {
 
 	// The init centroids will be instances choosen randomly (Forgy's Method)
 	int *selInstances = new int[conf -> K];
+	Rng rng(conf -> seed, rngStream(RNG_CENTROIDS, 0, 0));
 	for (int k = 0; k < conf -> K; ++k) {
 		bool exists = false;
 		int randomInstance;
 
 		// Avoid repeat centroids
 		do {
-			randomInstance = rand() % conf -> trNInstances;
+			randomInstance = rng.uniformInt(conf -> trNInstances);
 			exists = false;
 
 			// Look if the generated index already exists
@@ -0,0 +1,187 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file fitnessCache.cpp
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Implementation of the cache which stores the fitness of the already evaluated chromosomes
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+/********************************* Includes *******************************/
+
+#include "fitnessCache.h"
+#include <stdio.h> // fprintf
+#include <string.h> // memset
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Mixes the bits of a 64-bit word (finalizer of SplitMix64)
+ * @param x The word to be mixed
+ * @return The mixed word
+ */
+static inline uint64_t mix64(uint64_t x) {
+
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+
+/**
+ * @brief Gets the 128-bit hash of a chromosome
+ * @param chromosome The bit-packed chromosome to be hashed
+ * @param nFeatures The number of features of the chromosome
+ * @return The hash of the chromosome
+ */
+FitnessKey hashChromosome(const uint64_t *const chromosome, const int nFeatures) {
+
+	FitnessKey key;
+	key.h1 = 0x9E3779B97F4A7C15ULL ^ (uint64_t) nFeatures;
+	key.h2 = 0xC2B2AE3D27D4EB4FULL + (uint64_t) nFeatures;
+
+	// The genes are already packed in words of 64 bits. Each word is added to two independent streams
+	for (int w = 0; w < (nFeatures + 63) / 64; ++w) {
+		key.h1 = mix64(key.h1 ^ chromosome[w]);
+		key.h2 = mix64(key.h2 + (chromosome[w] * 0xFF51AFD7ED558CCDULL));
+	}
+
+	return key;
+}
+
+
+/**
+ * @brief The constructor with parameters
+ * @param capacity The maximum number of chromosomes stored in the cache. It is rounded up to a multiple of 'FC_WAYS'
+ */
+FitnessCache::FitnessCache(const int capacity) {
+
+	this -> nSets = (capacity + FC_WAYS - 1) / FC_WAYS;
+	this -> entries = new FitnessEntry[this -> nSets * FC_WAYS];
+	this -> hands = new unsigned char[this -> nSets];
+	memset(this -> entries, 0, this -> nSets * FC_WAYS * sizeof(FitnessEntry));
+	memset(this -> hands, 0, this -> nSets * sizeof(unsigned char));
+	for (int l = 0; l < FC_LOCKS; ++l) {
+		omp_init_lock(&(this -> locks[l]));
+	}
+	this -> hits = 0;
+	this -> misses = 0;
+	this -> evictions = 0;
+}
+
+
+/**
+ * @brief The destructor
+ */
+FitnessCache::~FitnessCache() {
+
+	// Resources used are released
+	for (int l = 0; l < FC_LOCKS; ++l) {
+		omp_destroy_lock(&(this -> locks[l]));
+	}
+	delete[] this -> entries;
+	delete[] this -> hands;
+}
+
+
+/**
+ * @brief Looks for a chromosome in the cache
+ * @param key The hash of the chromosome
+ * @param fitness The raw fitness of the chromosome will be stored if it is found
+ * @return true if the chromosome was found
+ */
+bool FitnessCache::lookup(const FitnessKey &key, float *const fitness) {
+
+	int set = (int) (key.h1 % this -> nSets);
+	FitnessEntry *const ways = this -> entries + (set * FC_WAYS);
+	bool found = false;
+
+	omp_set_lock(&(this -> locks[set % FC_LOCKS]));
+	for (int w = 0; w < FC_WAYS && !found; ++w) {
+		if (ways[w].used && ways[w].key.h1 == key.h1 && ways[w].key.h2 == key.h2) {
+			fitness[0] = ways[w].fitness[0];
+			fitness[1] = ways[w].fitness[1];
+			ways[w].referenced = true;
+			found = true;
+		}
+	}
+	omp_unset_lock(&(this -> locks[set % FC_LOCKS]));
+
+	if (found) {
+		#pragma omp atomic
+		++(this -> hits);
+	}
+	else {
+		#pragma omp atomic
+		++(this -> misses);
+	}
+
+	return found;
+}
+
+
+/**
+ * @brief Inserts the raw fitness of a chromosome in the cache. If its set is full, an entry is replaced
+ * @param key The hash of the chromosome
+ * @param fitness The raw fitness (before normalization) of the chromosome
+ */
+void FitnessCache::insert(const FitnessKey &key, const float *const fitness) {
+
+	int set = (int) (key.h1 % this -> nSets);
+	FitnessEntry *const ways = this -> entries + (set * FC_WAYS);
+	FitnessEntry *entry = NULL;
+	bool evicted = false;
+
+	omp_set_lock(&(this -> locks[set % FC_LOCKS]));
+
+	// The chromosome already exists or there is a free entry
+	for (int w = 0; w < FC_WAYS && entry == NULL; ++w) {
+		if (!ways[w].used || (ways[w].key.h1 == key.h1 && ways[w].key.h2 == key.h2)) {
+			entry = &ways[w];
+		}
+	}
+
+	// CLOCK algorithm: the referenced entries get a second chance
+	if (entry == NULL) {
+		unsigned char hand = this -> hands[set];
+		while (ways[hand].referenced) {
+			ways[hand].referenced = false;
+			hand = (hand + 1) % FC_WAYS;
+		}
+		entry = &ways[hand];
+		this -> hands[set] = (hand + 1) % FC_WAYS;
+		evicted = true;
+	}
+
+	entry -> key = key;
+	entry -> fitness[0] = fitness[0];
+	entry -> fitness[1] = fitness[1];
+	entry -> used = true;
+	entry -> referenced = false;
+	omp_unset_lock(&(this -> locks[set % FC_LOCKS]));
+
+	if (evicted) {
+		#pragma omp atomic
+		++(this -> evictions);
+	}
+}
+
+
+/**
+ * @brief Prints the hit-rate counters of the cache
+ * @param mpiRank The MPI process number which is calling the function
+ */
+void FitnessCache::printStats(const int mpiRank) {
+
+	long long lookups = this -> hits + this -> misses;
+	double hitRate = (lookups > 0) ? (100.0 * this -> hits) / lookups : 0.0;
+	fprintf(stderr, "Process %d: Fitness cache: %lld lookups, %lld hits (%.2f%%), %lld misses, %lld evictions\n", mpiRank, lookups, this -> hits, hitRate, this -> misses, this -> evictions);
+}
@@ -0,0 +1,227 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file gemm.cpp
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Implementation of the cache-blocked matrix product used by the batched K-means
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+/********************************* Includes *******************************/
+
+#include "gemm.h"
+#include <immintrin.h> // AVX2, AVX-512...
+#include <algorithm> // std::min
+
+/********************************* Defines ********************************/
+
+#define GEMM_MR 6 // Rows of C computed by the micro-kernel (instances)
+#define GEMM_NR 16 // Columns of C computed by the micro-kernel (centroids). One AVX-512 register
+#define GEMM_KC 256 // Depth of the packed panels. A panel of B must fit in the L1 cache
+#define GEMM_MC 72 // Rows of the packed block of A (multiple of 'GEMM_MR'). It must fit in the L2 cache
+#define GEMM_NC 240 // Columns of the packed block of B (multiple of 'GEMM_NR')
+
+/******************************** Structures ******************************/
+
+/**
+ * @brief Signature of the micro-kernels which compute a 'GEMM_MR' x 'GEMM_NR' tile of C from two packed panels
+ */
+typedef void (*MicroKernel)(const int, const float *const, const float *const, float *const);
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Scalar version of the micro-kernel. It is used when the CPU has not any of the supported vector extensions
+ * @param kc The depth of the panels
+ * @param a The packed panel of A. It contains 'GEMM_MR' elements for each step
+ * @param b The packed panel of B. It contains 'GEMM_NR' elements for each step
+ * @param tile The 'GEMM_MR' x 'GEMM_NR' resulting tile will be stored
+ */
+static void microKernelScalar(const int kc, const float *const a, const float *const b, float *const tile) {
+
+	float acc[GEMM_MR * GEMM_NR];
+	for (int rc = 0; rc < GEMM_MR * GEMM_NR; ++rc) {
+		acc[rc] = 0.0f;
+	}
+	for (int p = 0; p < kc; ++p) {
+		for (int r = 0; r < GEMM_MR; ++r) {
+			const float ar = a[(p * GEMM_MR) + r];
+			for (int c = 0; c < GEMM_NR; ++c) {
+				acc[(r * GEMM_NR) + c] += ar * b[(p * GEMM_NR) + c];
+			}
+		}
+	}
+	for (int rc = 0; rc < GEMM_MR * GEMM_NR; ++rc) {
+		tile[rc] = acc[rc];
+	}
+}
+
+
+/**
+ * @brief AVX2 version of the micro-kernel. The tile is kept in 12 registers
+ */
+__attribute__((target("avx2")))
+static void microKernelAVX2(const int kc, const float *const a, const float *const b, float *const tile) {
+
+	__m256 acc[GEMM_MR][2];
+	for (int r = 0; r < GEMM_MR; ++r) {
+		acc[r][0] = _mm256_setzero_ps();
+		acc[r][1] = _mm256_setzero_ps();
+	}
+	for (int p = 0; p < kc; ++p) {
+		const __m256 b0 = _mm256_load_ps(b + (p * GEMM_NR));
+		const __m256 b1 = _mm256_load_ps(b + (p * GEMM_NR) + 8);
+		for (int r = 0; r < GEMM_MR; ++r) {
+			const __m256 ar = _mm256_broadcast_ss(a + (p * GEMM_MR) + r);
+			acc[r][0] = _mm256_add_ps(acc[r][0], _mm256_mul_ps(ar, b0));
+			acc[r][1] = _mm256_add_ps(acc[r][1], _mm256_mul_ps(ar, b1));
+		}
+	}
+	for (int r = 0; r < GEMM_MR; ++r) {
+		_mm256_storeu_ps(tile + (r * GEMM_NR), acc[r][0]);
+		_mm256_storeu_ps(tile + (r * GEMM_NR) + 8, acc[r][1]);
+	}
+}
+
+
+/**
+ * @brief AVX-512 version of the micro-kernel. The tile is kept in 6 registers
+ */
+__attribute__((target("avx512f")))
+static void microKernelAVX512(const int kc, const float *const a, const float *const b, float *const tile) {
+
+	__m512 acc[GEMM_MR];
+	for (int r = 0; r < GEMM_MR; ++r) {
+		acc[r] = _mm512_setzero_ps();
+	}
+	for (int p = 0; p < kc; ++p) {
+		const __m512 bp = _mm512_load_ps(b + (p * GEMM_NR));
+		for (int r = 0; r < GEMM_MR; ++r) {
+			acc[r] = _mm512_add_ps(acc[r], _mm512_mul_ps(_mm512_set1_ps(a[(p * GEMM_MR) + r]), bp));
+		}
+	}
+	for (int r = 0; r < GEMM_MR; ++r) {
+		_mm512_storeu_ps(tile + (r * GEMM_NR), acc[r]);
+	}
+}
+
+
+/**
+ * @brief Selects the best micro-kernel supported by the CPU
+ * @return A pointer to the selected micro-kernel
+ */
+static MicroKernel selectMicroKernel() {
+
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		return microKernelAVX512;
+	}
+	else if (__builtin_cpu_supports("avx2")) {
+		return microKernelAVX2;
+	}
+	else {
+		return microKernelScalar;
+	}
+}
+
+
+/**
+ * @brief The micro-kernel selected at program start-up
+ */
+static const MicroKernel microKernel = selectMicroKernel();
+
+
+/**
+ * @brief Gets the size of the workspace needed by the matrix product
+ * @return The number of floats of the workspace
+ */
+int sgemmWorkspaceSize() {
+
+	return (GEMM_MC * GEMM_KC) + (GEMM_KC * GEMM_NC) + (GEMM_MR * GEMM_NR);
+}
+
+
+/**
+ * @brief Computes the product C = A * B^T in simple precision. All the matrices are stored in row-major order
+ *
+ * The matrices are split in blocks which fit in the caches and packed for a vectorized micro-kernel. Each element of C adds the products in the same order with all the instruction sets, so the results do not depend on the CPU
+ * @param M The number of rows of A and C
+ * @param N The number of rows of B and columns of C
+ * @param depth The number of columns of A and B
+ * @param A The first matrix
+ * @param lda The distance between two consecutive rows of A
+ * @param B The second matrix
+ * @param ldb The distance between two consecutive rows of B
+ * @param C The resulting matrix will be stored
+ * @param ldc The distance between two consecutive rows of C
+ * @param workspace Buffer of 'sgemmWorkspaceSize()' floats aligned to 64 bytes where the blocks are packed
+ */
+void sgemmNT(const int M, const int N, const int depth, const float *const A, const int lda, const float *const B, const int ldb, float *const C, const int ldc, float *const workspace) {
+
+	float *const packA = workspace;
+	float *const packB = packA + (GEMM_MC * GEMM_KC);
+	float *const tile = packB + (GEMM_KC * GEMM_NC);
+
+	if (depth == 0) {
+		for (int i = 0; i < M; ++i) {
+			for (int j = 0; j < N; ++j) {
+				C[(i * ldc) + j] = 0.0f;
+			}
+		}
+		return;
+	}
+
+	for (int jc = 0; jc < N; jc += GEMM_NC) {
+		const int nc = std::min(GEMM_NC, N - jc);
+		for (int pc = 0; pc < depth; pc += GEMM_KC) {
+			const int kc = std::min(GEMM_KC, depth - pc);
+
+			// Pack the block of B in panels of 'GEMM_NR' columns. The missing columns are filled with zeros
+			for (int jr = 0; jr < nc; jr += GEMM_NR) {
+				float *const panel = packB + (jr * kc);
+				for (int p = 0; p < kc; ++p) {
+					for (int c = 0; c < GEMM_NR; ++c) {
+						panel[(p * GEMM_NR) + c] = (jr + c < nc) ? B[((jc + jr + c) * ldb) + pc + p] : 0.0f;
+					}
+				}
+			}
+
+			for (int ic = 0; ic < M; ic += GEMM_MC) {
+				const int mc = std::min(GEMM_MC, M - ic);
+
+				// Pack the block of A in panels of 'GEMM_MR' rows
+				for (int ir = 0; ir < mc; ir += GEMM_MR) {
+					float *const panel = packA + (ir * kc);
+					for (int p = 0; p < kc; ++p) {
+						for (int r = 0; r < GEMM_MR; ++r) {
+							panel[(p * GEMM_MR) + r] = (ir + r < mc) ? A[((ic + ir + r) * lda) + pc + p] : 0.0f;
+						}
+					}
+				}
+
+				// The partial products of each block of depth are added to C
+				for (int jr = 0; jr < nc; jr += GEMM_NR) {
+					const int nr = std::min(GEMM_NR, nc - jr);
+					for (int ir = 0; ir < mc; ir += GEMM_MR) {
+						const int mr = std::min(GEMM_MR, mc - ir);
+						microKernel(kc, packA + (ir * kc), packB + (jr * kc), tile);
+						for (int r = 0; r < mr; ++r) {
+							float *const rowC = C + ((ic + ir + r) * ldc) + jc + jr;
+							for (int c = 0; c < nr; ++c) {
+								rowC[c] = (pc == 0) ? tile[(r * GEMM_NR) + c] : rowC[c] + tile[(r * GEMM_NR) + c];
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+}
@@ -20,88 +20,181 @@
 #include "individual.h"
 #include <algorithm> // sort...
 #include <math.h> // INFINITY...
+#include <numeric> // std::iota
 #include <vector> // std::vector...
 
+/******************************** Structures ******************************/
+
+/**
+ * @brief The fields of an individual used to sort the subpopulation and its original position
+ */
+typedef struct SortKey {
+	float fitness[2]; // Individual fitness for the multi-objective functions
+	float crowding; // Crowding distance of the individual
+	int rank; // Range of the individual (Pareto front)
+	int index; // Position of the individual in the subpopulation before sorting
+} SortKey;
+
 /********************************* Methods ********************************/
 
 /**
- * @brief Perform non-dominated sorting on the subpopulation
+ * @brief Checks if an individual dominates another one
+ * @param ind1 The first individual
+ * @param ind2 The second individual
+ * @param nObjectives The number of objectives
+ * @return true if the first individual is not worse in any objective and it is better in at least one
+ */
+static bool dominates(const Individual &ind1, const Individual &ind2, const int nObjectives) {
+
+	bool better = false;
+	for (int obj = 0; obj < nObjectives; ++obj) {
+		if (ind1.fitness[obj] > ind2.fitness[obj]) {
+			return false;
+		}
+		better |= (ind1.fitness[obj] < ind2.fitness[obj]);
+	}
+
+	return better;
+}
+
+
+/**
+ * @brief Sorts the indexes of the individuals in lexicographic order of their objectives. An individual can only be dominated by the previous ones
  * @param subpop Current subpopulation
  * @param nIndividuals The number of individuals which will be sorted
- * @param conf The structure with all configuration parameters
- * @return The number of individuals in the front 0
+ * @param nObjectives The number of objectives
+ * @param order The sorted indexes will be stored
  */
-int nonDominationSort(Individual *const subpop, const int nIndividuals, const Config *const conf) {
+static void lexicographicOrder(const Individual *const subpop, const int nIndividuals, const int nObjectives, std::vector<int> &order) {
 
-	// Individuals to classify (really they are not 'Individual' objects)
-	// Each 'Individual' p of 'indivDomination' contains the number of individuals...
-	// ...who dominate p and a list of individuals who are dominated by p
-	std::vector< std::pair< std::vector<int>, int> > indivDomination(nIndividuals);
-	std::vector< std::vector<int> > front(1);
-
-	// Search for individuals who belong to the first front
-	int nFronts = 0;
-	for (int i = 0; i < nIndividuals; ++i) {
-		for (int j = i + 1; j < nIndividuals; ++j) {
-			u_char domLess = 0;
-			u_char domEqual = 0;
-			u_char domMore = 0;
-			for (u_char obj = 0; obj < conf -> nObjectives; ++obj) {
-				if (subpop[i].fitness[obj] < subpop[j].fitness[obj]) {
-					++domLess;
-				}
-				else if (subpop[i].fitness[obj] == subpop[j].fitness[obj]) {
-					++domEqual;
-				}
-				else {
-					++domMore;
-				}
+	order.resize(nIndividuals);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [subpop, nObjectives](const int a, const int b) {
+		for (int obj = 0; obj < nObjectives; ++obj) {
+			if (subpop[a].fitness[obj] != subpop[b].fitness[obj]) {
+				return subpop[a].fitness[obj] < subpop[b].fitness[obj];
 			}
+		}
+		return a < b;
+	});
+}
 
-			if (domLess == 0 && domEqual != conf -> nObjectives) {
-				++indivDomination[i].second;
-				indivDomination[j].first.push_back(i);
+
+/**
+ * @brief Assigns the rank of the individuals when there are two objectives
+ *
+ * The individuals are visited in lexicographic order. The last individual of each front has the lowest second objective of the front, so it alone decides if the front dominates the current individual. The fronts which dominate it are always the first ones, so its front is found with a binary search. O(N log N)
+ * @param subpop Current subpopulation
+ * @param order The indexes of the individuals in lexicographic order
+ * @param frontSizes The number of individuals of each front will be stored
+ */
+static void rankTwoObjectives(Individual *const subpop, const std::vector<int> &order, std::vector<int> &frontSizes) {
+
+	std::vector<int> last;
+	for (size_t i = 0; i < order.size(); ++i) {
+		Individual *const ind = subpop + order[i];
+		int low = 0;
+		int high = (int) last.size();
+		while (low < high) {
+			int mid = (low + high) >> 1;
+			const Individual *const q = subpop + last[mid];
+			if (q -> fitness[1] < ind -> fitness[1] || (q -> fitness[1] == ind -> fitness[1] && q -> fitness[0] < ind -> fitness[0])) {
+				low = mid + 1;
 			}
-			else if (domMore == 0 && domEqual != conf -> nObjectives) {
-				indivDomination[i].first.push_back(j);
-				++indivDomination[j].second;
+			else {
+				high = mid;
 			}
 		}
-
-		if (indivDomination[i].second == 0) {
-			subpop[i].rank = 0;
-			front[0].push_back(i);
+		if (low == (int) last.size()) {
+			last.push_back(order[i]);
+			frontSizes.push_back(0);
+		}
+		else {
+			last[low] = order[i];
 		}
+		ind -> rank = low;
+		++frontSizes[low];
 	}
+}
 
-	// Find the subsequent fronts
-	while (!front[nFronts].empty()) {
-		front.push_back(std::vector<int>());
-		int sizeActualFront = front[nFronts].size();
-		for (int i = 0; i < sizeActualFront; ++i) {
-			int nDomByInd = (int) indivDomination[front[nFronts][i]].first.size();
-			for (int j = 0; j < nDomByInd; ++j) {
-				int dominateToInd = indivDomination[front[nFronts][i]].first[j];
-				int nDomToInd = (--indivDomination[dominateToInd].second);
-				if (nDomToInd == 0) {
-					subpop[dominateToInd].rank = nFronts + 1;
-						front[nFronts + 1].push_back(dominateToInd);
-				}
+
+/**
+ * @brief Assigns the rank of the individuals for any number of objectives (efficient non-dominated sort with sequential search)
+ *
+ * The individuals are visited in lexicographic order and each one is placed in the first front without any individual dominating it
+ * @param subpop Current subpopulation
+ * @param order The indexes of the individuals in lexicographic order
+ * @param nObjectives The number of objectives
+ * @param frontSizes The number of individuals of each front will be stored
+ */
+static void rankGeneric(Individual *const subpop, const std::vector<int> &order, const int nObjectives, std::vector<int> &frontSizes) {
+
+	std::vector< std::vector<int> > fronts;
+	for (size_t i = 0; i < order.size(); ++i) {
+		Individual *const ind = subpop + order[i];
+		int f = 0;
+		bool dominated = true;
+		while (f < (int) fronts.size() && dominated) {
+
+			// The last individuals of the front are the most likely to dominate it
+			dominated = false;
+			for (int j = (int) fronts[f].size() - 1; j >= 0 && !dominated; --j) {
+				dominated = dominates(subpop[fronts[f][j]], *ind, nObjectives);
 			}
+			f += dominated;
 		}
-		++nFronts;
+		if (f == (int) fronts.size()) {
+			fronts.push_back(std::vector<int>());
+		}
+		fronts[f].push_back(order[i]);
+		ind -> rank = f;
 	}
 
-	front.pop_back();
+	for (size_t f = 0; f < fronts.size(); ++f) {
+		frontSizes.push_back((int) fronts[f].size());
+	}
+}
+
+
+/**
+ * @brief Perform non-dominated sorting on the subpopulation
+ * @param subpop Current subpopulation
+ * @param nIndividuals The number of individuals which will be sorted
+ * @param conf The structure with all configuration parameters
+ * @return The number of individuals in the front 0
+ */
+int nonDominationSort(Individual *const subpop, const int nIndividuals, const Config *const conf) {
+
+	// Rank of each individual (Pareto front) and the size of each front
+	std::vector<int> order;
+	std::vector<int> frontSizes;
+	lexicographicOrder(subpop, nIndividuals, conf -> nObjectives, order);
+	if (conf -> nObjectives == 2) {
+		rankTwoObjectives(subpop, order, frontSizes);
+	}
+	else {
+		rankGeneric(subpop, order, conf -> nObjectives, frontSizes);
+	}
+	int nFronts = (int) frontSizes.size();
+
+	// The individuals are sorted through compact keys, so the cost does not depend on the length of the chromosome
+	std::vector<SortKey> keys(nIndividuals);
+	for (int i = 0; i < nIndividuals; ++i) {
+		keys[i].fitness[0] = subpop[i].fitness[0];
+		keys[i].fitness[1] = subpop[i].fitness[1];
+		keys[i].crowding = subpop[i].crowding;
+		keys[i].rank = subpop[i].rank;
+		keys[i].index = i;
+	}
 
 	// Sort the individuals according to the rank
-	std::sort(subpop, subpop + nIndividuals, rankCompare());
+	std::sort(keys.begin(), keys.end(), rankCompare());
 
 	// Find the crowding distance for each individual in each front
 	for (int f = 0, i = 0; f < nFronts; ++f) {
-		int sizeFrontI = (int) front[f].size();
-		Individual *begin = subpop + i;
-		Individual *end = begin + sizeFrontI;
+		int sizeFrontI = frontSizes[f];
+		SortKey *begin = keys.data() + i;
+		SortKey *end = begin + sizeFrontI;
 		for (u_char obj = 0; obj < conf -> nObjectives; ++obj) {
 			std::sort(begin, end, objectiveCompare(obj));
 			float fMin = begin -> fitness[obj];
@@ -111,7 +204,7 @@ int nonDominationSort(Individual *const subpop, const int nIndividuals, const Co
 			bool fMaxFminZero = (fMax == fMin);
 
 			for (int j = 1; j < sizeFrontI - 1; ++j) {
-				Individual *current = begin + j;
+				SortKey *current = begin + j;
 				if (fMaxFminZero) {
 					current -> crowding = INFINITY;
 				}
@@ -127,7 +220,26 @@ int nonDominationSort(Individual *const subpop, const int nIndividuals, const Co
 	}
 
 	// Sort the individuals according to the rank and Crowding distance
-	std::sort(subpop, subpop + nIndividuals, rankAndCrowdingCompare());
+	std::sort(keys.begin(), keys.end(), rankAndCrowdingCompare());
+
+	// The permutation is applied once. Each individual is moved directly to its final position following the cycles of the permutation
+	std::vector<bool> placed(nIndividuals, false);
+	for (int i = 0; i < nIndividuals; ++i) {
+		if (!placed[i] && keys[i].index != i) {
+			Individual first = subpop[i];
+			int dst = i;
+			while (keys[dst].index != i) {
+				subpop[dst] = subpop[keys[dst].index];
+				placed[dst] = true;
+				dst = keys[dst].index;
+			}
+			subpop[dst] = first;
+			placed[dst] = true;
+		}
+	}
+	for (int i = 0; i < nIndividuals; ++i) {
+		subpop[i].crowding = keys[i].crowding;
+	}
 
-	return front[0].size();
+	return (nFronts > 0) ? frontSizes[0] : 0;
 }
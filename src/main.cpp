@@ -40,7 +40,6 @@ int main(const int argc, const char **argv) {
 	Config conf(argc, argv);
 	Individual *subpops;
 	int *selInstances;
-	srand((uint) time(NULL) + conf.mpiRank); // '+ rank' is necessary in MPI
 
 	// Master
 	if (conf.mpiRank == 0 && conf.mpiSize > 1) {
@@ -56,7 +55,10 @@ int main(const int argc, const char **argv) {
 
 		/********** Genetic algorithm ***********/
 
-		agIslands(subpops, NULL, NULL, NULL, &conf);
+		// The workers only tune their devices in the autotuning mode
+		if (!conf.autotune) {
+			agIslands(subpops, NULL, NULL, NULL, NULL, NULL, NULL, &conf);
+		}
 	}
 
 	// Workers
@@ -83,10 +85,41 @@ int main(const int argc, const char **argv) {
 
 		// Sequential, only 1 device (CPU or GPU) or heterogeneous mode if more than 1 device is available
 		CLDevice *devices = createDevices(trDataBase, selInstances, transposedTrDataBase, &conf);
-		agIslands(subpops, devices, trDataBase, selInstances, &conf);
+		FitnessCache *fitnessCache = NULL;
+		PartitionTable *partitionTable = NULL;
+		Profiler *profiler = NULL;
+
+		// The autotuning mode measures the devices of the host with the database of the experiment instead of running the genetic algorithm
+		if (conf.autotune) {
+			autotuneDevices(devices, &conf);
+		}
+		else {
+			fitnessCache = (conf.fitnessCacheSize > 0) ? new FitnessCache(conf.fitnessCacheSize) : NULL;
+			partitionTable = (conf.warmStartSize > 0) ? new PartitionTable(conf.warmStartSize, conf.trNInstances) : NULL;
+			profiler = (!conf.profileFileName.empty()) ? new Profiler(devices, conf.nDevices) : NULL;
+			agIslands(subpops, devices, trDataBase, selInstances, fitnessCache, partitionTable, profiler, &conf);
+
+			// Report the K-means iterations and the efficiency of the fitness cache and the warm start
+			printEvaluationStats(devices, &conf);
+			if (fitnessCache != NULL) {
+				fitnessCache -> printStats(conf.mpiRank);
+			}
+			if (partitionTable != NULL) {
+				partitionTable -> printStats(conf.mpiRank);
+			}
+
+			// Each process writes its own profiling file
+			if (profiler != NULL) {
+				profiler -> printStats(conf.mpiRank);
+				profiler -> write((conf.mpiSize > 1) ? conf.profileFileName + "." + std::to_string(conf.mpiRank) : conf.profileFileName, conf.mpiRank);
+			}
+		}
 
 		// Exclusive variables used by the workers are released
 		delete[] devices;
+		delete fitnessCache;
+		delete partitionTable;
+		delete profiler;
 		delete[] trDataBase;
 		delete[] transposedTrDataBase;
 	}
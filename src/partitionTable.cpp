@@ -0,0 +1,118 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file partitionTable.cpp
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Implementation of the table which stores the final K-means partitions used to warm-start the children
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+/********************************* Includes *******************************/
+
+#include "partitionTable.h"
+#include <stdio.h> // fprintf
+#include <string.h> // memcpy, memset
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief The constructor with parameters
+ * @param capacity The maximum number of partitions stored in the table
+ * @param nInstances The number of instances of each partition
+ */
+PartitionTable::PartitionTable(const int capacity, const int nInstances) {
+
+	this -> capacity = capacity;
+	this -> nInstances = nInstances;
+	this -> partitions = new unsigned char[(size_t) capacity * nInstances];
+	this -> keys = new uint64_t[capacity];
+	memset(this -> keys, 0, capacity * sizeof(uint64_t));
+	for (int l = 0; l < PT_LOCKS; ++l) {
+		omp_init_lock(&(this -> locks[l]));
+	}
+	this -> hits = 0;
+	this -> misses = 0;
+}
+
+
+/**
+ * @brief The destructor
+ */
+PartitionTable::~PartitionTable() {
+
+	// Resources used are released
+	for (int l = 0; l < PT_LOCKS; ++l) {
+		omp_destroy_lock(&(this -> locks[l]));
+	}
+	delete[] this -> partitions;
+	delete[] this -> keys;
+}
+
+
+/**
+ * @brief Looks for the partition of a chromosome
+ * @param key The hash of the chromosome. 0 always fails
+ * @param partition The partition will be stored if it is found
+ * @return true if the partition was found
+ */
+bool PartitionTable::lookup(const uint64_t key, unsigned char *const partition) {
+
+	int entry = (int) (key % this -> capacity);
+	bool found = false;
+
+	if (key != 0) {
+		omp_set_lock(&(this -> locks[entry % PT_LOCKS]));
+		if (this -> keys[entry] == key) {
+			memcpy(partition, this -> partitions + ((size_t) entry * this -> nInstances), this -> nInstances);
+			found = true;
+		}
+		omp_unset_lock(&(this -> locks[entry % PT_LOCKS]));
+	}
+
+	if (found) {
+		#pragma omp atomic
+		++(this -> hits);
+	}
+	else {
+		#pragma omp atomic
+		++(this -> misses);
+	}
+
+	return found;
+}
+
+
+/**
+ * @brief Stores the partition of a chromosome, replacing the previous content of its entry
+ * @param key The hash of the chromosome
+ * @param partition The cluster of each instance
+ */
+void PartitionTable::insert(const uint64_t key, const unsigned char *const partition) {
+
+	int entry = (int) (key % this -> capacity);
+
+	omp_set_lock(&(this -> locks[entry % PT_LOCKS]));
+	this -> keys[entry] = key;
+	memcpy(this -> partitions + ((size_t) entry * this -> nInstances), partition, this -> nInstances);
+	omp_unset_lock(&(this -> locks[entry % PT_LOCKS]));
+}
+
+
+/**
+ * @brief Prints the hit-rate counters of the table
+ * @param mpiRank The MPI process number which is calling the function
+ */
+void PartitionTable::printStats(const int mpiRank) {
+
+	long long lookups = this -> hits + this -> misses;
+	double hitRate = (lookups > 0) ? (100.0 * this -> hits) / lookups : 0.0;
+	fprintf(stderr, "Process %d: Warm start: %lld lookups, %lld parent partitions found (%.2f%%)\n", mpiRank, lookups, this -> hits, hitRate);
+}
@@ -0,0 +1,226 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file profiler.cpp
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Implementation of the profiler which records the commands executed by the devices during the evaluation
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+/********************************* Includes *******************************/
+
+#include "profiler.h"
+#include "config.h" // check
+#include <stdio.h> // fprintf, fopen...
+#include <map> // std::map
+#include <tuple> // std::tuple
+#include <algorithm> // std::sort, std::min, std::max
+
+/******************************** Structures ******************************/
+
+/**
+ * @brief Aggregated times (in nanoseconds) of the commands of a device in an island and a generation
+ */
+typedef struct ProfileSummary {
+	long long chunks; // Number of executed kernels
+	long long nIndividuals; // Number of evaluated individuals
+	double write; // Time copying the chromosomes
+	double kernel; // Time computing K-means
+	double read; // Time copying the fitness
+	double wait; // Time between the enqueue and the start of the commands
+	double idle; // Time without any command running between the first enqueue and the last end
+} ProfileSummary;
+
+/**
+ * @brief The key of an aggregation: device, island and generation
+ */
+typedef std::tuple<int, int, int> ProfileKey;
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Aggregates the recorded commands per device, island and generation
+ * @param records The recorded commands
+ * @param summaries The aggregated times will be stored
+ */
+static void aggregate(const std::vector<ProfileRecord> &records, std::map<ProfileKey, ProfileSummary> &summaries) {
+
+	// The commands of each group. The timestamps of different devices are not comparable
+	std::map<ProfileKey, std::vector<const ProfileRecord*> > groups;
+	for (size_t r = 0; r < records.size(); ++r) {
+		groups[ProfileKey(records[r].device, records[r].island, records[r].generation)].push_back(&records[r]);
+	}
+
+	for (auto group = groups.begin(); group != groups.end(); ++group) {
+		std::vector<const ProfileRecord*> &commands = group -> second;
+		ProfileSummary summary = {0, 0, 0.0, 0.0, 0.0, 0.0, 0.0};
+		unsigned long long first = commands[0] -> queued;
+		unsigned long long last = commands[0] -> end;
+		for (size_t c = 0; c < commands.size(); ++c) {
+			double duration = (double) (commands[c] -> end - commands[c] -> start);
+			if (commands[c] -> phase == PROF_WRITE) {
+				summary.write += duration;
+			}
+			else if (commands[c] -> phase == PROF_READ) {
+				summary.read += duration;
+			}
+			else {
+				summary.kernel += duration;
+				++summary.chunks;
+				summary.nIndividuals += commands[c] -> nIndividuals;
+			}
+			summary.wait += (double) (commands[c] -> start - commands[c] -> queued);
+			first = std::min(first, commands[c] -> queued);
+			last = std::max(last, commands[c] -> end);
+		}
+
+		// The busy time is the union of the intervals of the commands, because several of them can overlap
+		std::sort(commands.begin(), commands.end(), [](const ProfileRecord *a, const ProfileRecord *b) { return a -> start < b -> start; });
+		double busy = 0.0;
+		unsigned long long busyStart = commands[0] -> start;
+		unsigned long long busyEnd = commands[0] -> end;
+		for (size_t c = 1; c < commands.size(); ++c) {
+			if (commands[c] -> start > busyEnd) {
+				busy += (double) (busyEnd - busyStart);
+				busyStart = commands[c] -> start;
+			}
+			busyEnd = std::max(busyEnd, commands[c] -> end);
+		}
+		busy += (double) (busyEnd - busyStart);
+		summary.idle = std::max(0.0, (double) (last - first) - busy);
+		summaries[group -> first] = summary;
+	}
+}
+
+
+/**
+ * @brief The constructor with parameters
+ * @param devices The devices whose commands will be recorded
+ * @param nDevices The number of devices
+ */
+Profiler::Profiler(const CLDevice *const devices, const int nDevices) {
+
+	this -> devices = devices;
+	this -> nDevices = nDevices;
+	omp_init_lock(&(this -> lock));
+}
+
+
+/**
+ * @brief The destructor
+ */
+Profiler::~Profiler() {
+
+	// Resources used are released
+	omp_destroy_lock(&(this -> lock));
+}
+
+
+/**
+ * @brief Records a command executed by a device
+ * @param device The device which executed the command
+ * @param island The island whose individuals were evaluated
+ * @param generation The generation of the island
+ * @param phase The kind of command ('PROF_WRITE', 'PROF_KERNEL' or 'PROF_READ')
+ * @param nIndividuals The number of individuals of the chunk
+ * @param queued The moment when the command was enqueued
+ * @param submit The moment when the command was submitted to the device
+ * @param start The moment when the command started its execution
+ * @param end The moment when the command finished its execution
+ */
+void Profiler::record(const CLDevice *const device, const int island, const int generation, const int phase, const int nIndividuals, const unsigned long long queued, const unsigned long long submit, const unsigned long long start, const unsigned long long end) {
+
+	ProfileRecord record;
+	record.device = (int) (device - this -> devices);
+	record.island = island;
+	record.generation = generation;
+	record.phase = phase;
+	record.nIndividuals = nIndividuals;
+	record.queued = queued;
+	record.submit = submit;
+	record.start = start;
+	record.end = end;
+
+	omp_set_lock(&(this -> lock));
+	this -> records.push_back(record);
+	omp_unset_lock(&(this -> lock));
+}
+
+
+/**
+ * @brief Records an OpenCL command already finished
+ * @param device The device which executed the command
+ * @param island The island whose individuals were evaluated
+ * @param generation The generation of the island
+ * @param phase The kind of command ('PROF_WRITE', 'PROF_KERNEL' or 'PROF_READ')
+ * @param nIndividuals The number of individuals of the chunk
+ * @param event The event associated to the command
+ */
+void Profiler::record(const CLDevice *const device, const int island, const int generation, const int phase, const int nIndividuals, const cl_event event) {
+
+	cl_ulong queued, submit, start, end;
+	check(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_QUEUED, sizeof(cl_ulong), &queued, NULL) != CL_SUCCESS, "%s\n", PROF_ERROR_EVENT);
+	check(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_SUBMIT, sizeof(cl_ulong), &submit, NULL) != CL_SUCCESS, "%s\n", PROF_ERROR_EVENT);
+	check(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_START, sizeof(cl_ulong), &start, NULL) != CL_SUCCESS, "%s\n", PROF_ERROR_EVENT);
+	check(clGetEventProfilingInfo(event, CL_PROFILING_COMMAND_END, sizeof(cl_ulong), &end, NULL) != CL_SUCCESS, "%s\n", PROF_ERROR_EVENT);
+	record(device, island, generation, phase, nIndividuals, queued, submit, start, end);
+}
+
+
+/**
+ * @brief Prints a table with the transfer, compute and idle time of each device
+ * @param mpiRank The MPI process number which is calling the function
+ */
+void Profiler::printStats(const int mpiRank) {
+
+	std::map<ProfileKey, ProfileSummary> summaries;
+	aggregate(this -> records, summaries);
+
+	// The groups of each device are added
+	std::vector<ProfileSummary> totals(this -> nDevices, ProfileSummary {0, 0, 0.0, 0.0, 0.0, 0.0, 0.0});
+	for (auto s = summaries.begin(); s != summaries.end(); ++s) {
+		ProfileSummary &total = totals[std::get<0>(s -> first)];
+		total.chunks += s -> second.chunks;
+		total.nIndividuals += s -> second.nIndividuals;
+		total.write += s -> second.write;
+		total.kernel += s -> second.kernel;
+		total.read += s -> second.read;
+		total.wait += s -> second.wait;
+		total.idle += s -> second.idle;
+	}
+
+	fprintf(stderr, "Process %d: Profiling (ms)   %-24s %8s %11s %11s %11s %11s %11s %11s\n", mpiRank, "Device", "Chunks", "Individuals", "Write", "Kernel", "Read", "Wait", "Idle");
+	for (int dev = 0; dev < this -> nDevices; ++dev) {
+		const ProfileSummary &total = totals[dev];
+		fprintf(stderr, "Process %d: Profiling (ms)   %-24s %8lld %11lld %11.3f %11.3f %11.3f %11.3f %11.3f\n", mpiRank, this -> devices[dev].deviceName.c_str(), total.chunks, total.nIndividuals, total.write * 1e-6, total.kernel * 1e-6, total.read * 1e-6, total.wait * 1e-6, total.idle * 1e-6);
+	}
+}
+
+
+/**
+ * @brief Writes the transfer, compute and idle time of each device, island and generation in CSV format
+ * @param fileName The name of the file
+ * @param mpiRank The MPI process number which is calling the function
+ */
+void Profiler::write(const std::string &fileName, const int mpiRank) {
+
+	std::map<ProfileKey, ProfileSummary> summaries;
+	aggregate(this -> records, summaries);
+
+	FILE *file = fopen(fileName.c_str(), "w");
+	check(file == NULL, "%s\n", PROF_ERROR_FILE_OPEN);
+	fprintf(file, "process,device,island,generation,chunks,individuals,write_ms,kernel_ms,read_ms,wait_ms,idle_ms\n");
+	for (auto s = summaries.begin(); s != summaries.end(); ++s) {
+		const ProfileSummary &summary = s -> second;
+		fprintf(file, "%d,\"%s\",%d,%d,%lld,%lld,%.6f,%.6f,%.6f,%.6f,%.6f\n", mpiRank, this -> devices[std::get<0>(s -> first)].deviceName.c_str(), std::get<1>(s -> first), std::get<2>(s -> first), summary.chunks, summary.nIndividuals, summary.write * 1e-6, summary.kernel * 1e-6, summary.read * 1e-6, summary.wait * 1e-6, summary.idle * 1e-6);
+	}
+	check(fclose(file) != 0, "%s\n", PROF_ERROR_FILE_OPEN);
+}
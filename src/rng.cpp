@@ -0,0 +1,104 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file rng.cpp
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Implementation of the counter-based random number generator used by the genetic algorithm
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+/********************************* Includes *******************************/
+
+#include "rng.h"
+
+/********************************* Defines ********************************/
+
+#define PHILOX_M0 0xD2511F53U // Multipliers of the rounds
+#define PHILOX_M1 0xCD9E8D57U
+#define PHILOX_W0 0x9E3779B9U // Increments of the key between rounds
+#define PHILOX_W1 0xBB67AE85U
+#define PHILOX_ROUNDS 10
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Mixes a 64-bit value (SplitMix64 finalizer)
+ * @param x The value
+ * @return The mixed value
+ */
+static uint64_t mix64(uint64_t x) {
+
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+
+/**
+ * @brief The constructor with parameters
+ * @param seed The seed of the run
+ * @param stream The stream, obtained with 'rngStream'
+ */
+Rng::Rng(const uint64_t seed, const uint64_t stream) {
+
+	this -> key[0] = (uint32_t) seed;
+	this -> key[1] = (uint32_t) (seed >> 32);
+	this -> counter[0] = 0;
+	this -> counter[1] = 0;
+	this -> counter[2] = (uint32_t) stream;
+	this -> counter[3] = (uint32_t) (stream >> 32);
+	this -> used = 4;
+}
+
+
+/**
+ * @brief Generates the next block of numbers and advances the counter
+ */
+void Rng::refill() {
+
+	uint32_t c0 = this -> counter[0], c1 = this -> counter[1], c2 = this -> counter[2], c3 = this -> counter[3];
+	uint32_t k0 = this -> key[0], k1 = this -> key[1];
+	for (int r = 0; r < PHILOX_ROUNDS; ++r) {
+		uint64_t p0 = (uint64_t) PHILOX_M0 * c0;
+		uint64_t p1 = (uint64_t) PHILOX_M1 * c2;
+		c0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+		c1 = (uint32_t) p1;
+		c2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+		c3 = (uint32_t) p0;
+		k0 += PHILOX_W0;
+		k1 += PHILOX_W1;
+	}
+	this -> block[0] = c0;
+	this -> block[1] = c1;
+	this -> block[2] = c2;
+	this -> block[3] = c3;
+	this -> used = 0;
+
+	// The position of the block is a 64-bit counter
+	if (++(this -> counter[0]) == 0) {
+		++(this -> counter[1]);
+	}
+}
+
+
+/**
+ * @brief Gets the stream of a task of the genetic algorithm. The same task always gets the same stream, whatever thread or MPI process runs it
+ * @param kind The kind of task ('RNG_INIT', 'RNG_CENTROIDS', 'RNG_EVOLUTION' or 'RNG_MIGRATION')
+ * @param island The island (subpopulation) of the task
+ * @param generation The generation or migration of the task
+ * @return The stream
+ */
+uint64_t rngStream(const int kind, const int island, const int generation) {
+
+	uint64_t stream = mix64((uint64_t) kind + 0x9E3779B97F4A7C15ULL);
+	stream = mix64(stream ^ (uint32_t) island);
+	return mix64(stream ^ (uint32_t) generation);
+}
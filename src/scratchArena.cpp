@@ -0,0 +1,56 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file scratchArena.cpp
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Implementation of the per-thread memory arenas used as scratch space by the evaluation
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+/********************************* Includes *******************************/
+
+#include "scratchArena.h"
+#include <stdlib.h> // posix_memalign, free
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief The constructor. No memory is reserved
+ */
+ScratchArena::ScratchArena() {
+
+	this -> memory = NULL;
+	this -> capacity = 0;
+	this -> used = 0;
+}
+
+
+/**
+ * @brief The destructor
+ */
+ScratchArena::~ScratchArena() {
+
+	// Resources used are released
+	free(this -> memory);
+}
+
+
+/**
+ * @brief Reserves the memory of the arena. The previous memory is released
+ * @param capacity The size in bytes of the arena
+ */
+void ScratchArena::reserve(const size_t capacity) {
+
+	free(this -> memory);
+	check(posix_memalign((void **) &(this -> memory), SA_ALIGNMENT, capacity) != 0, "%s\n", SA_ERROR_ALLOC);
+	this -> capacity = capacity;
+	this -> used = 0;
+}
@@ -0,0 +1,330 @@
+/**
+ * This file is subject to the terms and conditions defined in
+ * file 'LICENSE', which is part of Hpmoon repository.
+ *
+ * This work has been funded by:
+ *
+ * Spanish 'Ministerio de Economía y Competitividad' under grants number TIN2012-32039 and TIN2015-67020-P.\n
+ * Spanish 'Ministerio de Ciencia, Innovación y Universidades' under grant number PGC2018-098813-B-C31.\n
+ * European Regional Development Fund (ERDF).
+ *
+ * @file simd.cpp
+ * @author Juan José Escobar Pérez
+ * @date 16/10/2026
+ * @brief Implementation of the vectorized K-means kernels for the CPU. The instruction set is selected at runtime
+ * @copyright Hpmoon (c) 2015 University of Granada
+ */
+
+/********************************* Includes *******************************/
+
+#include "simd.h"
+#include <immintrin.h> // SSE, AVX2, AVX-512...
+#include <math.h> // INFINITY
+#include <stddef.h> // NULL
+
+/********************************* Defines ********************************/
+
+#define CENTROIDS_PER_BLOCK 4
+
+/******************************** Structures ******************************/
+
+/**
+ * @brief Signature of the kernels which assign the instances to the nearest centroid
+ */
+typedef void (*AssignFunction)(const float *const, const int, const int, const float *const, const int, const int, const int, unsigned char *const, float *const, float *const);
+
+/********************************* Methods ********************************/
+
+/**
+ * @brief Scalar version of the kernel. It is used when the CPU has not any of the supported vector extensions
+ */
+static void assignScalar(const float *const selDataBase, const int stride, const int nSelFeatures, const float *const centroids, const int K, const int begin, const int end, unsigned char *const mapping, float *const distCentroids, float *const secondDist) {
+
+	for (int i = begin; i < end; ++i) {
+		float minDist = INFINITY;
+		float secondMinDist = INFINITY;
+		int selectCentroid = 0;
+		for (int k = 0; k < K; ++k) {
+			const float *const centr = centroids + (k * nSelFeatures);
+			float dist = 0.0f;
+			for (int j = 0; j < nSelFeatures; ++j) {
+				float dif = selDataBase[(stride * j) + i] - centr[j];
+				dist += dif * dif;
+			}
+
+			if (dist < minDist) {
+				secondMinDist = minDist;
+				minDist = dist;
+				selectCentroid = k;
+			}
+			else if (dist < secondMinDist) {
+				secondMinDist = dist;
+			}
+		}
+
+		distCentroids[i] = minDist;
+		mapping[i] = selectCentroid;
+		if (secondDist != NULL) {
+			secondDist[i] = secondMinDist;
+		}
+	}
+}
+
+
+/**
+ * @brief SSE4.2 version of the kernel. 4 instances are computed at the same time
+ */
+__attribute__((target("sse4.2")))
+static void assignSSE(const float *const selDataBase, const int stride, const int nSelFeatures, const float *const centroids, const int K, const int begin, const int end, unsigned char *const mapping, float *const distCentroids, float *const secondDist) {
+
+	alignas(16) float minDistLanes[4];
+	alignas(16) float secondLanes[4];
+	alignas(16) int selectLanes[4];
+	for (int i = begin; i < end; i += 4) {
+		__m128 minDist = _mm_set1_ps(INFINITY);
+		__m128 secondMinDist = _mm_set1_ps(INFINITY);
+		__m128 selectCentroid = _mm_setzero_ps();
+
+		// The distances to a block of centroids are kept in registers
+		for (int k = 0; k < K; k += CENTROIDS_PER_BLOCK) {
+			const int nk = (K - k < CENTROIDS_PER_BLOCK) ? K - k : CENTROIDS_PER_BLOCK;
+			const float *const centr = centroids + (k * nSelFeatures);
+			__m128 dist0 = _mm_setzero_ps(), dist1 = _mm_setzero_ps(), dist2 = _mm_setzero_ps(), dist3 = _mm_setzero_ps();
+			for (int j = 0; j < nSelFeatures; ++j) {
+				__m128 x = _mm_load_ps(selDataBase + (stride * j) + i);
+				__m128 dif = _mm_sub_ps(x, _mm_set1_ps(centr[j]));
+				dist0 = _mm_add_ps(dist0, _mm_mul_ps(dif, dif));
+				if (nk > 1) {
+					dif = _mm_sub_ps(x, _mm_set1_ps(centr[nSelFeatures + j]));
+					dist1 = _mm_add_ps(dist1, _mm_mul_ps(dif, dif));
+				}
+				if (nk > 2) {
+					dif = _mm_sub_ps(x, _mm_set1_ps(centr[(nSelFeatures << 1) + j]));
+					dist2 = _mm_add_ps(dist2, _mm_mul_ps(dif, dif));
+				}
+				if (nk > 3) {
+					dif = _mm_sub_ps(x, _mm_set1_ps(centr[(3 * nSelFeatures) + j]));
+					dist3 = _mm_add_ps(dist3, _mm_mul_ps(dif, dif));
+				}
+			}
+
+			// Lane-wise minimum. The lowest centroid wins the ties as in the scalar version
+			__m128 dists[CENTROIDS_PER_BLOCK] = {dist0, dist1, dist2, dist3};
+			for (int kk = 0; kk < nk; ++kk) {
+				secondMinDist = _mm_min_ps(secondMinDist, _mm_max_ps(minDist, dists[kk]));
+				__m128 lower = _mm_cmplt_ps(dists[kk], minDist);
+				minDist = _mm_blendv_ps(minDist, dists[kk], lower);
+				selectCentroid = _mm_blendv_ps(selectCentroid, _mm_castsi128_ps(_mm_set1_epi32(k + kk)), lower);
+			}
+		}
+
+		// Only the valid instances are stored
+		_mm_store_ps(minDistLanes, minDist);
+		_mm_store_ps(secondLanes, secondMinDist);
+		_mm_store_si128((__m128i *) selectLanes, _mm_castps_si128(selectCentroid));
+		for (int l = 0; l < 4 && i + l < end; ++l) {
+			distCentroids[i + l] = minDistLanes[l];
+			mapping[i + l] = selectLanes[l];
+			if (secondDist != NULL) {
+				secondDist[i + l] = secondLanes[l];
+			}
+		}
+	}
+}
+
+
+/**
+ * @brief AVX2 version of the kernel. 8 instances are computed at the same time
+ */
+__attribute__((target("avx2")))
+static void assignAVX2(const float *const selDataBase, const int stride, const int nSelFeatures, const float *const centroids, const int K, const int begin, const int end, unsigned char *const mapping, float *const distCentroids, float *const secondDist) {
+
+	alignas(32) int selectLanes[8];
+	for (int i = begin; i < end; i += 8) {
+		__m256 minDist = _mm256_set1_ps(INFINITY);
+		__m256 secondMinDist = _mm256_set1_ps(INFINITY);
+		__m256i selectCentroid = _mm256_setzero_si256();
+
+		// The distances to a block of centroids are kept in registers
+		for (int k = 0; k < K; k += CENTROIDS_PER_BLOCK) {
+			const int nk = (K - k < CENTROIDS_PER_BLOCK) ? K - k : CENTROIDS_PER_BLOCK;
+			const float *const centr = centroids + (k * nSelFeatures);
+			__m256 dist0 = _mm256_setzero_ps(), dist1 = _mm256_setzero_ps(), dist2 = _mm256_setzero_ps(), dist3 = _mm256_setzero_ps();
+			for (int j = 0; j < nSelFeatures; ++j) {
+				__m256 x = _mm256_load_ps(selDataBase + (stride * j) + i);
+				__m256 dif = _mm256_sub_ps(x, _mm256_set1_ps(centr[j]));
+				dist0 = _mm256_add_ps(dist0, _mm256_mul_ps(dif, dif));
+				if (nk > 1) {
+					dif = _mm256_sub_ps(x, _mm256_set1_ps(centr[nSelFeatures + j]));
+					dist1 = _mm256_add_ps(dist1, _mm256_mul_ps(dif, dif));
+				}
+				if (nk > 2) {
+					dif = _mm256_sub_ps(x, _mm256_set1_ps(centr[(nSelFeatures << 1) + j]));
+					dist2 = _mm256_add_ps(dist2, _mm256_mul_ps(dif, dif));
+				}
+				if (nk > 3) {
+					dif = _mm256_sub_ps(x, _mm256_set1_ps(centr[(3 * nSelFeatures) + j]));
+					dist3 = _mm256_add_ps(dist3, _mm256_mul_ps(dif, dif));
+				}
+			}
+
+			// Lane-wise minimum. The lowest centroid wins the ties as in the scalar version
+			__m256 dists[CENTROIDS_PER_BLOCK] = {dist0, dist1, dist2, dist3};
+			for (int kk = 0; kk < nk; ++kk) {
+				secondMinDist = _mm256_min_ps(secondMinDist, _mm256_max_ps(minDist, dists[kk]));
+				__m256 lower = _mm256_cmp_ps(dists[kk], minDist, _CMP_LT_OQ);
+				minDist = _mm256_blendv_ps(minDist, dists[kk], lower);
+				selectCentroid = _mm256_blendv_epi8(selectCentroid, _mm256_set1_epi32(k + kk), _mm256_castps_si256(lower));
+			}
+		}
+
+		// Only the valid instances are stored
+		const int valid = (end - i < 8) ? end - i : 8;
+		__m256i tail = _mm256_cmpgt_epi32(_mm256_set1_epi32(valid), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+		_mm256_maskstore_ps(distCentroids + i, tail, minDist);
+		if (secondDist != NULL) {
+			_mm256_maskstore_ps(secondDist + i, tail, secondMinDist);
+		}
+		_mm256_store_si256((__m256i *) selectLanes, selectCentroid);
+		for (int l = 0; l < valid; ++l) {
+			mapping[i + l] = selectLanes[l];
+		}
+	}
+}
+
+
+// The headers of GCC 12 and older implement _mm512_min_ps and _mm512_max_ps with _mm512_undefined_ps, a self-initialized variable...
+// ...which is reported as uninitialized once inlined (GCC bug 105593). The warning is only silenced in this function
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 13
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+/**
+ * @brief AVX-512 version of the kernel. 16 instances are computed at the same time and the last ones are masked
+ */
+__attribute__((target("avx512f")))
+static void assignAVX512(const float *const selDataBase, const int stride, const int nSelFeatures, const float *const centroids, const int K, const int begin, const int end, unsigned char *const mapping, float *const distCentroids, float *const secondDist) {
+
+	for (int i = begin; i < end; i += 16) {
+		const __mmask16 tail = (end - i < 16) ? (__mmask16) ((1u << (end - i)) - 1) : (__mmask16) 0xFFFF;
+		__m512 minDist = _mm512_set1_ps(INFINITY);
+		__m512 secondMinDist = _mm512_set1_ps(INFINITY);
+		__m512i selectCentroid = _mm512_setzero_si512();
+
+		// The distances to a block of centroids are kept in registers
+		for (int k = 0; k < K; k += CENTROIDS_PER_BLOCK) {
+			const int nk = (K - k < CENTROIDS_PER_BLOCK) ? K - k : CENTROIDS_PER_BLOCK;
+			const float *const centr = centroids + (k * nSelFeatures);
+			__m512 dist0 = _mm512_setzero_ps(), dist1 = _mm512_setzero_ps(), dist2 = _mm512_setzero_ps(), dist3 = _mm512_setzero_ps();
+			for (int j = 0; j < nSelFeatures; ++j) {
+				__m512 x = _mm512_maskz_load_ps(tail, selDataBase + (stride * j) + i);
+				__m512 dif = _mm512_sub_ps(x, _mm512_set1_ps(centr[j]));
+				dist0 = _mm512_add_ps(dist0, _mm512_mul_ps(dif, dif));
+				if (nk > 1) {
+					dif = _mm512_sub_ps(x, _mm512_set1_ps(centr[nSelFeatures + j]));
+					dist1 = _mm512_add_ps(dist1, _mm512_mul_ps(dif, dif));
+				}
+				if (nk > 2) {
+					dif = _mm512_sub_ps(x, _mm512_set1_ps(centr[(nSelFeatures << 1) + j]));
+					dist2 = _mm512_add_ps(dist2, _mm512_mul_ps(dif, dif));
+				}
+				if (nk > 3) {
+					dif = _mm512_sub_ps(x, _mm512_set1_ps(centr[(3 * nSelFeatures) + j]));
+					dist3 = _mm512_add_ps(dist3, _mm512_mul_ps(dif, dif));
+				}
+			}
+
+			// Lane-wise minimum. The lowest centroid wins the ties as in the scalar version
+			__m512 dists[CENTROIDS_PER_BLOCK] = {dist0, dist1, dist2, dist3};
+			for (int kk = 0; kk < nk; ++kk) {
+				secondMinDist = _mm512_min_ps(secondMinDist, _mm512_max_ps(minDist, dists[kk]));
+				__mmask16 lower = _mm512_cmp_ps_mask(dists[kk], minDist, _CMP_LT_OQ);
+				minDist = _mm512_mask_mov_ps(minDist, lower, dists[kk]);
+				selectCentroid = _mm512_mask_mov_epi32(selectCentroid, lower, _mm512_set1_epi32(k + kk));
+			}
+		}
+
+		// Only the valid instances are stored
+		_mm512_mask_storeu_ps(distCentroids + i, tail, minDist);
+		if (secondDist != NULL) {
+			_mm512_mask_storeu_ps(secondDist + i, tail, secondMinDist);
+		}
+		_mm512_mask_cvtepi32_storeu_epi8(mapping + i, tail, selectCentroid);
+	}
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ < 13
+#pragma GCC diagnostic pop
+#endif
+
+
+/**
+ * @brief Selects the best kernel supported by the CPU
+ * @return A pointer to the selected kernel
+ */
+static AssignFunction selectAssignFunction() {
+
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f")) {
+		return assignAVX512;
+	}
+	else if (__builtin_cpu_supports("avx2")) {
+		return assignAVX2;
+	}
+	else if (__builtin_cpu_supports("sse4.2")) {
+		return assignSSE;
+	}
+	else {
+		return assignScalar;
+	}
+}
+
+
+/**
+ * @brief The kernel selected at program start-up
+ */
+static const AssignFunction assignFunction = selectAssignFunction();
+
+
+/**
+ * @brief Assigns each instance to its nearest centroid (Euclidean distance)
+ *
+ * The K distances of several instances are kept in vector registers at the same time. Each lane adds the features in the same order, so all the instruction sets produce the same results
+ * @param selDataBase The selected features of the database in feature-major order. The rows are aligned and padded to 'SIMD_MAX_WIDTH'
+ * @param stride The length of each row of 'selDataBase'
+ * @param nSelFeatures The number of selected features (rows of 'selDataBase')
+ * @param centroids The centroids. Each one contains 'nSelFeatures' coordinates
+ * @param K The number of centroids
+ * @param begin The first instance to be assigned. It must be a multiple of 'SIMD_MAX_WIDTH'
+ * @param end The 'end-1' position is the last instance to be assigned
+ * @param mapping The nearest centroid of each instance will be stored
+ * @param distCentroids The squared distance to the nearest centroid of each instance will be stored
+ * @param secondDist The squared distance to the second nearest centroid of each instance will be stored. NULL if it is not needed
+ */
+void assignInstances(const float *const selDataBase, const int stride, const int nSelFeatures, const float *const centroids, const int K, const int begin, const int end, unsigned char *const mapping, float *const distCentroids, float *const secondDist) {
+
+	assignFunction(selDataBase, stride, nSelFeatures, centroids, K, begin, end, mapping, distCentroids, secondDist);
+}
+
+
+/**
+ * @brief Gets the name of the instruction set used by the K-means kernels
+ * @return The name of the instruction set selected at runtime
+ */
+const char *simdInstructionSet() {
+
+	if (assignFunction == assignAVX512) {
+		return "AVX-512";
+	}
+	else if (assignFunction == assignAVX2) {
+		return "AVX2";
+	}
+	else if (assignFunction == assignSSE) {
+		return "SSE4.2";
+	}
+	else {
+		return "Scalar";
+	}
+}